@@ -0,0 +1,174 @@
+#include "aig.hpp"
+#include <algorithm>
+#include <utility>
+
+AIG::AIG() : strash(64, 0), strashBits(6) {
+    // node 0 is the constant false node
+    nodes.push_back(AigNode{AIG_INPUT_MARK, AIG_INPUT_MARK});
+    levels.push_back(0);
+}
+
+AigLit AIG::addInput(const std::string& name) {
+    uint32_t idx = nodes.size();
+    nodes.push_back(AigNode{AIG_INPUT_MARK, (AigLit)inputNodes.size()});
+    levels.push_back(0);
+    inputNodes.push_back(idx);
+    inputNames.push_back(name);
+    return aigMakeLit(idx);
+}
+
+AigLit AIG::namedInput(const std::string& name) {
+    auto it = inputsByName.find(name);
+    if (it != inputsByName.end()) {
+        return it->second;
+    }
+    auto lit = addInput(name);
+    inputsByName[name] = lit;
+    return lit;
+}
+
+size_t AIG::strashSlot(AigLit a, AigLit b) const {
+    // Fibonacci hashing, the top bits of the product mix all of the key
+    const uint64_t key = ((uint64_t)a << 32) | b;
+    return (key * 0x9e3779b97f4a7c15ull) >> (64 - strashBits);
+}
+
+void AIG::growStrash() {
+    std::vector<uint32_t> old(strash.size() * 2, 0);
+    old.swap(strash);
+    strashBits++;
+    const size_t mask = strash.size() - 1;
+    for (uint32_t idx : old) {
+        if (idx == 0) {
+            continue;
+        }
+        size_t i = strashSlot(nodes[idx].fanin0, nodes[idx].fanin1);
+        while (strash[i] != 0) {
+            i = (i + 1) & mask;
+        }
+        strash[i] = idx;
+    }
+}
+
+AigLit AIG::makeAnd(AigLit a, AigLit b) {
+    // constant propagation and trivial simplifications
+    if (a > b) {
+        std::swap(a, b);
+    }
+    if (a == AIG_FALSE) {
+        return AIG_FALSE;
+    }
+    if (a == AIG_TRUE) {
+        return b;
+    }
+    if (a == b) {
+        return a;
+    }
+    if (a == aigNot(b)) {
+        return AIG_FALSE;
+    }
+
+    // structural hashing, fanins are ordered so that a & b == b & a
+    const size_t mask = strash.size() - 1;
+    size_t i = strashSlot(a, b);
+    for (; strash[i] != 0; i = (i + 1) & mask) {
+        const auto& node = nodes[strash[i]];
+        if (node.fanin0 == a && node.fanin1 == b) {
+            return aigMakeLit(strash[i]);
+        }
+    }
+
+    uint32_t idx = nodes.size();
+    nodes.push_back(AigNode{a, b});
+    levels.push_back(1 + std::max(levels[aigNode(a)], levels[aigNode(b)]));
+    strash[i] = idx;
+    if (andCount() * 2 > strash.size()) {
+        growStrash();
+    }
+    return aigMakeLit(idx);
+}
+
+AigLit AIG::makeOr(AigLit a, AigLit b) {
+    return aigNot(makeAnd(aigNot(a), aigNot(b)));
+}
+
+AigLit AIG::makeXor(AigLit a, AigLit b) {
+    return makeOr(makeAnd(a, aigNot(b)), makeAnd(aigNot(a), b));
+}
+
+AigLit AIG::makeImplication(AigLit a, AigLit b) {
+    return aigNot(makeAnd(a, aigNot(b)));
+}
+
+AigLit AIG::makeBiconditional(AigLit a, AigLit b) {
+    return aigNot(makeXor(a, b));
+}
+
+std::vector<AigLit> AIG::append(const AIG& other,
+                                const std::vector<AigLit>& roots) {
+    while (inputCount() < other.inputCount()) {
+        addInput(other.inputName(inputCount()));
+    }
+
+    std::vector<AigLit> nodeMap(other.nodeCount(), AIG_FALSE);
+    for (size_t idx = 1; idx < other.nodeCount(); idx++) {
+        if (other.isInput(idx)) {
+            nodeMap[idx] = aigMakeLit(inputNodes[other.inputIndex(idx)]);
+            continue;
+        }
+        const auto& n = other.node(idx);
+        nodeMap[idx] = makeAnd(
+            aigNotIf(nodeMap[aigNode(n.fanin0)], aigIsComplemented(n.fanin0)),
+            aigNotIf(nodeMap[aigNode(n.fanin1)], aigIsComplemented(n.fanin1)));
+    }
+
+    std::vector<AigLit> mapped;
+    for (auto lit : roots) {
+        mapped.push_back(aigNotIf(nodeMap[aigNode(lit)], aigIsComplemented(lit)));
+    }
+    return mapped;
+}
+
+std::vector<bool> AIG::markCone(const std::vector<AigLit>& roots) const {
+    // nodes are topologically ordered, so a single backwards sweep marks the
+    // whole cone without recursion
+    std::vector<bool> marked(nodes.size(), false);
+    uint32_t highest = 0;
+    for (auto lit : roots) {
+        marked[aigNode(lit)] = true;
+        highest = std::max(highest, aigNode(lit));
+    }
+    for (int64_t idx = highest; idx > 0; idx--) {
+        if (marked[idx] && isAnd(idx)) {
+            marked[aigNode(nodes[idx].fanin0)] = true;
+            marked[aigNode(nodes[idx].fanin1)] = true;
+        }
+    }
+    return marked;
+}
+
+std::vector<size_t> AIG::support(const std::vector<AigLit>& roots) const {
+    auto marked = markCone(roots);
+    std::vector<size_t> inputs;
+    for (size_t i = 0; i < inputNodes.size(); i++) {
+        if (marked[inputNodes[i]]) {
+            inputs.push_back(i);
+        }
+    }
+    return inputs;
+}
+
+size_t AIG::coneSize(const std::vector<AigLit>& roots) const {
+    auto marked = markCone(roots);
+    size_t count = 0;
+    for (size_t idx = 1; idx < nodes.size(); idx++) {
+        if (marked[idx] && isAnd(idx)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+size_t AIG::coneSize(AigLit root) const {
+    return coneSize(std::vector<AigLit>{root});
+}
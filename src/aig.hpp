@@ -0,0 +1,104 @@
+#ifndef AIG_H
+#define AIG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// An AIG literal is a node index shifted left by one with the lowest bit set
+// when the edge is complemented (inverted). Node 0 is the constant node, so
+// literal 0 is false and literal 1 is true.
+using AigLit = uint32_t;
+
+const AigLit AIG_FALSE = 0;
+const AigLit AIG_TRUE = 1;
+
+inline AigLit aigMakeLit(uint32_t node, bool complemented = false) {
+    return (node << 1) | (complemented ? 1 : 0);
+}
+inline uint32_t aigNode(AigLit lit) { return lit >> 1; }
+inline bool aigIsComplemented(AigLit lit) { return lit & 1; }
+inline AigLit aigNot(AigLit lit) { return lit ^ 1; }
+inline AigLit aigNotIf(AigLit lit, bool c) { return lit ^ (c ? 1 : 0); }
+
+// A node is either the constant, a primary input or a two-input AND gate.
+// Inputs and the constant carry AIG_INPUT_MARK in their first fanin, inputs
+// keep their input index in the second one, so the whole node array stays a
+// flat vector of 8 byte entries.
+const AigLit AIG_INPUT_MARK = UINT32_MAX;
+
+struct AigNode {
+    AigLit fanin0;
+    AigLit fanin1;
+};
+
+// And-inverter graph with structural hashing. Nodes are only ever appended,
+// and every AND node is created after both of its fanins, so the node array
+// is always in topological order.
+class AIG {
+private:
+    std::vector<AigNode> nodes;
+    std::vector<uint32_t> levels;
+    std::vector<uint32_t> inputNodes;
+    std::vector<std::string> inputNames;
+    std::unordered_map<std::string, AigLit> inputsByName;
+    // structural hashing, open addressing over the indices of the AND nodes
+    // (0 marks a free slot) kept at most half full, as a node based map
+    // spends a heap allocation and a cache miss on every gate of a large
+    // expression
+    std::vector<uint32_t> strash;
+    unsigned strashBits;
+
+    size_t strashSlot(AigLit a, AigLit b) const;
+    void growStrash();
+
+    std::vector<bool> markCone(const std::vector<AigLit>& roots) const;
+
+public:
+    AIG();
+
+    AigLit addInput(const std::string& name = "");
+    AigLit namedInput(const std::string& name);
+    void setInputName(size_t i, const std::string& name) {
+        inputNames[i] = name;
+    }
+
+    AigLit makeAnd(AigLit a, AigLit b);
+    AigLit makeOr(AigLit a, AigLit b);
+    AigLit makeXor(AigLit a, AigLit b);
+    AigLit makeImplication(AigLit a, AigLit b);
+    AigLit makeBiconditional(AigLit a, AigLit b);
+
+    // Copies another AIG into this one, connecting its i-th input to this
+    // graph's i-th input (created when missing), and returns the literals
+    // the given roots of the other AIG map to.
+    std::vector<AigLit> append(const AIG& other,
+                               const std::vector<AigLit>& roots);
+
+    size_t nodeCount() const { return nodes.size(); }
+    size_t inputCount() const { return inputNodes.size(); }
+    size_t andCount() const { return nodes.size() - inputNodes.size() - 1; }
+    const AigNode& node(uint32_t idx) const { return nodes[idx]; }
+    const std::vector<AigNode>& getNodes() const { return nodes; }
+    bool isAnd(uint32_t idx) const {
+        return nodes[idx].fanin0 != AIG_INPUT_MARK;
+    }
+    bool isInput(uint32_t idx) const {
+        return !isAnd(idx) && nodes[idx].fanin1 != AIG_INPUT_MARK;
+    }
+    uint32_t inputIndex(uint32_t idx) const { return nodes[idx].fanin1; }
+    uint32_t inputNode(size_t i) const { return inputNodes[i]; }
+    const std::string& inputName(size_t i) const { return inputNames[i]; }
+
+    // Indices of the inputs in the transitive fanin cone of the literals.
+    std::vector<size_t> support(const std::vector<AigLit>& roots) const;
+    // Number of AND nodes in the transitive fanin cone of the literals.
+    size_t coneSize(const std::vector<AigLit>& roots) const;
+    size_t coneSize(AigLit root) const;
+    // Longest path, in AND nodes, from any input to the literal.
+    uint32_t depth(AigLit lit) const { return levels[aigNode(lit)]; }
+};
+
+#endif // AIG_H
@@ -0,0 +1,238 @@
+#include "aiger.hpp"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+static const AigLit UNMAPPED = AIG_INPUT_MARK;
+
+static void fail(const std::string& message) {
+    throw std::runtime_error("AIGER: " + message);
+}
+
+// Reads the next line starting at `pos`, leaving `pos` after its newline.
+static std::string readLine(const std::string& data, size_t& pos) {
+    if (pos >= data.size()) {
+        fail("unexpected end of file");
+    }
+    auto end = data.find('\n', pos);
+    if (end == std::string::npos) {
+        end = data.size();
+    }
+    auto line = data.substr(pos, end - pos);
+    pos = end + 1;
+    if (!line.empty() && line.back() == '\r') {
+        line.pop_back();
+    }
+    return line;
+}
+
+static std::vector<uint64_t> parseNumbers(const std::string& line,
+                                          size_t expected) {
+    std::istringstream ss(line);
+    std::vector<uint64_t> numbers;
+    uint64_t n;
+    while (ss >> n) {
+        numbers.push_back(n);
+    }
+    if (!ss.eof() || numbers.size() != expected) {
+        fail("malformed line `" + line + "`");
+    }
+    return numbers;
+}
+
+// Binary AND gates store their deltas as 7 bit little endian varints.
+static uint64_t decodeDelta(const std::string& data, size_t& pos) {
+    uint64_t value = 0;
+    int shift = 0;
+    while (true) {
+        if (pos >= data.size()) {
+            fail("unexpected end of file in binary AND section");
+        }
+        unsigned char byte = data[pos++];
+        value |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return value;
+        }
+        shift += 7;
+        if (shift > 63) {
+            fail("invalid delta encoding");
+        }
+    }
+}
+
+AigerCircuit readAiger(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        fail("cannot open " + path);
+    }
+    std::string data((std::istreambuf_iterator<char>(file)),
+                     std::istreambuf_iterator<char>());
+
+    size_t pos = 0;
+    std::istringstream header(readLine(data, pos));
+    std::string format;
+    uint64_t maxVar, numInputs, numLatches, numOutputs, numAnds;
+    if (!(header >> format >> maxVar >> numInputs >> numLatches >>
+          numOutputs >> numAnds) ||
+        (format != "aag" && format != "aig")) {
+        fail("missing `aag`/`aig` header");
+    }
+    // AIGER 1.9 adds bad state, invariant, justice and fairness counts
+    uint64_t extra;
+    while (header >> extra) {
+        if (extra != 0) {
+            fail("bad state, invariant, justice and fairness properties are "
+                 "not supported");
+        }
+    }
+    if (numLatches != 0) {
+        fail("sequential circuits (latches) are not supported");
+    }
+    if (numInputs + numAnds > maxVar || maxVar >= (1u << 30)) {
+        fail("inconsistent header");
+    }
+    bool binary = format == "aig";
+    // The vectors below are sized from the header, so it must not declare
+    // more than the file can hold. Every output and AND gate takes two
+    // bytes at least, as does every input of an ASCII file. Binary inputs
+    // take none, but a binary file numbers its variables without gaps.
+    const uint64_t lines = (binary ? 0 : numInputs) + numOutputs + numAnds;
+    if (lines > data.size() / 2 ||
+        (binary ? maxVar != numInputs + numAnds : maxVar > data.size())) {
+        fail("header declares more than the file holds");
+    }
+    if (numInputs > AIGER_MAX_INPUTS) {
+        fail("more than " + std::to_string(AIGER_MAX_INPUTS) + " inputs");
+    }
+
+    AigerCircuit circuit;
+    circuit.declaredAnds = numAnds;
+    auto& aig = circuit.aig;
+    std::vector<AigLit> litMap(maxVar + 1, UNMAPPED);
+    litMap[0] = AIG_FALSE;
+
+    for (uint64_t i = 0; i < numInputs; i++) {
+        uint64_t lit = binary ? 2 * (i + 1)
+                              : parseNumbers(readLine(data, pos), 1)[0];
+        if (lit < 2 || (lit & 1) || lit / 2 > maxVar ||
+            litMap[lit / 2] != UNMAPPED) {
+            fail("invalid input literal " + std::to_string(lit));
+        }
+        litMap[lit / 2] = aig.addInput("i" + std::to_string(i));
+    }
+
+    std::vector<uint64_t> outputLits(numOutputs);
+    for (auto& lit : outputLits) {
+        lit = parseNumbers(readLine(data, pos), 1)[0];
+        if (lit / 2 > maxVar) {
+            fail("invalid output literal " + std::to_string(lit));
+        }
+    }
+
+    // fanins of every AND gate, indexed by variable
+    std::vector<uint64_t> fanins(2 * (maxVar + 1), 0);
+    std::vector<bool> isGate(maxVar + 1, false);
+    std::vector<uint32_t> gateVars(numAnds);
+    for (uint64_t i = 0; i < numAnds; i++) {
+        uint64_t lhs, rhs0, rhs1;
+        if (binary) {
+            lhs = 2 * (numInputs + i + 1);
+            auto delta0 = decodeDelta(data, pos);
+            auto delta1 = decodeDelta(data, pos);
+            if (delta0 > lhs || delta1 > lhs - delta0) {
+                fail("invalid delta in AND gate " + std::to_string(lhs));
+            }
+            rhs0 = lhs - delta0;
+            rhs1 = rhs0 - delta1;
+        } else {
+            auto numbers = parseNumbers(readLine(data, pos), 3);
+            lhs = numbers[0];
+            rhs0 = numbers[1];
+            rhs1 = numbers[2];
+        }
+        if ((lhs & 1) || lhs < 2 || lhs / 2 > maxVar || rhs0 / 2 > maxVar ||
+            rhs1 / 2 > maxVar || litMap[lhs / 2] != UNMAPPED ||
+            isGate[lhs / 2]) {
+            fail("invalid AND gate " + std::to_string(lhs));
+        }
+        uint32_t var = lhs / 2;
+        isGate[var] = true;
+        fanins[2 * var] = rhs0;
+        fanins[2 * var + 1] = rhs1;
+        gateVars[i] = var;
+    }
+
+    // ASCII files need not list gates in topological order, so every gate
+    // is built through an explicit stack instead of recursion
+    std::vector<uint32_t> stack;
+    std::vector<bool> onStack(maxVar + 1, false);
+    for (auto root : gateVars) {
+        stack.push_back(root);
+        while (!stack.empty()) {
+            auto var = stack.back();
+            if (litMap[var] != UNMAPPED) {
+                stack.pop_back();
+                continue;
+            }
+            onStack[var] = true;
+            bool ready = true;
+            for (int k = 0; k < 2; k++) {
+                auto faninVar = fanins[2 * var + k] / 2;
+                if (litMap[faninVar] != UNMAPPED) {
+                    continue;
+                }
+                if (!isGate[faninVar]) {
+                    fail("undefined literal " +
+                         std::to_string(fanins[2 * var + k]));
+                }
+                if (onStack[faninVar]) {
+                    fail("combinational cycle through literal " +
+                         std::to_string(2 * faninVar));
+                }
+                stack.push_back(faninVar);
+                ready = false;
+            }
+            if (!ready) {
+                continue;
+            }
+            auto a = aigNotIf(litMap[fanins[2 * var] / 2], fanins[2 * var] & 1);
+            auto b = aigNotIf(litMap[fanins[2 * var + 1] / 2],
+                              fanins[2 * var + 1] & 1);
+            litMap[var] = aig.makeAnd(a, b);
+            onStack[var] = false;
+            stack.pop_back();
+        }
+    }
+
+    for (auto lit : outputLits) {
+        if (litMap[lit / 2] == UNMAPPED) {
+            fail("undefined output literal " + std::to_string(lit));
+        }
+        circuit.outputs.push_back(aigNotIf(litMap[lit / 2], lit & 1));
+        circuit.outputNames.push_back("o" +
+                                      std::to_string(circuit.outputs.size() - 1));
+    }
+
+    // optional symbol table, terminated by the comment section
+    while (pos < data.size()) {
+        auto line = readLine(data, pos);
+        if (line.empty() || line[0] == 'c') {
+            break;
+        }
+        auto space = line.find(' ');
+        if (space == std::string::npos || space < 2) {
+            fail("malformed symbol `" + line + "`");
+        }
+        auto index = std::stoull(line.substr(1, space - 1));
+        auto name = line.substr(space + 1);
+        if (line[0] == 'o' && index < numOutputs) {
+            circuit.outputNames[index] = name;
+        } else if (line[0] == 'i' && index < numInputs) {
+            aig.setInputName(index, name);
+        } else {
+            fail("malformed symbol `" + line + "`");
+        }
+    }
+
+    return circuit;
+}
@@ -0,0 +1,26 @@
+#ifndef AIGER_H
+#define AIGER_H
+
+#include "aig.hpp"
+#include <string>
+#include <vector>
+
+// A combinational circuit loaded from an AIGER file. The gates are rebuilt
+// through the AIG's structural hashing, so `aig` may hold fewer AND nodes
+// than the file declared.
+struct AigerCircuit {
+    AIG aig;
+    std::vector<AigLit> outputs;
+    std::vector<std::string> outputNames;
+    size_t declaredAnds = 0;
+};
+
+// Reads an ASCII (`aag`) or binary (`aig`) AIGER file. Throws
+// std::runtime_error for malformed files and for sequential circuits, since
+// only combinational logic is supported.
+AigerCircuit readAiger(const std::string& path);
+
+// Inputs take no room in a binary file, so their count is capped instead.
+const uint64_t AIGER_MAX_INPUTS = 1 << 20;
+
+#endif // AIGER_H
@@ -0,0 +1,61 @@
+#include "alloccount.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef COUNT_ALLOCATIONS
+
+static std::atomic<uint64_t> allocations{0};
+
+uint64_t heapAllocations() {
+    return allocations.load(std::memory_order_relaxed);
+}
+
+bool countsAllocations() { return true; }
+
+// The array and nothrow forms of the standard library call these two.
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    while (true) {
+        if (void* p = std::malloc(size ? size : 1)) {
+            return p;
+        }
+        auto handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    const size_t align = static_cast<size_t>(alignment);
+    // aligned_alloc wants a multiple of the alignment
+    const size_t rounded = ((size ? size : 1) + align - 1) & ~(align - 1);
+    while (true) {
+        if (void* p = std::aligned_alloc(align, rounded)) {
+            return p;
+        }
+        auto handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+#else
+
+uint64_t heapAllocations() { return 0; }
+
+bool countsAllocations() { return false; }
+
+#endif
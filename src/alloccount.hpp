@@ -0,0 +1,15 @@
+#ifndef ALLOCCOUNT_H
+#define ALLOCCOUNT_H
+
+#include <cstdint>
+
+// The number of allocations made through operator new by all threads since
+// the program started. They are only counted in builds made with
+// COUNT_ALLOCATIONS defined (make bench), where every form of operator new
+// is replaced to count them at the cost of one relaxed atomic increment per
+// allocation. Other builds keep the standard allocator and always return 0.
+uint64_t heapAllocations();
+// Whether this build counts allocations.
+bool countsAllocations();
+
+#endif // ALLOCCOUNT_H
@@ -0,0 +1,49 @@
+#include "arena.hpp"
+#include <algorithm>
+#include <cstdint>
+
+void* Arena::do_allocate(size_t bytes, size_t alignment) {
+    while (true) {
+        auto at = reinterpret_cast<uintptr_t>(next);
+        auto aligned = (at + alignment - 1) & ~(uintptr_t)(alignment - 1);
+        if (next && aligned + bytes <= reinterpret_cast<uintptr_t>(end)) {
+            next = reinterpret_cast<char*>(aligned + bytes);
+            used += bytes;
+            return reinterpret_cast<void*>(aligned);
+        }
+        // move on to the next block that is kept from before a reset, or
+        // add one large enough
+        if (next) {
+            current++;
+        }
+        while (current < blocks.size() &&
+               blocks[current].size < bytes + alignment) {
+            current++;
+        }
+        if (current >= blocks.size()) {
+            size_t size = blocks.empty() ? BLOCK_BYTES
+                                         : 2 * blocks.back().size;
+            size = std::max(size, bytes + alignment);
+            // not value initialized, the memory is not touched until used
+            blocks.push_back(Block{std::unique_ptr<char[]>(new char[size]), size});
+            current = blocks.size() - 1;
+        }
+        next = blocks[current].data.get();
+        end = next + blocks[current].size;
+    }
+}
+
+void Arena::reset() {
+    current = 0;
+    next = blocks.empty() ? nullptr : blocks[0].data.get();
+    end = blocks.empty() ? nullptr : next + blocks[0].size;
+    used = 0;
+}
+
+size_t Arena::capacity() const {
+    size_t total = 0;
+    for (auto& block : blocks) {
+        total += block.size;
+    }
+    return total;
+}
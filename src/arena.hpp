@@ -0,0 +1,50 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+// A monotonic memory resource for the state of one input: allocation bumps
+// a pointer, deallocation does nothing and reset() makes all of the memory
+// available again at once. Blocks are kept across resets, so once the
+// arena has grown to the size of the largest input seen, parsing and
+// evaluating an input takes no memory from the general heap.
+class Arena : public std::pmr::memory_resource {
+private:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+    std::vector<Block> blocks;
+    size_t current = 0;
+    char* next = nullptr;
+    char* end = nullptr;
+    size_t used = 0;
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other)
+        const noexcept override {
+        return this == &other;
+    }
+
+public:
+    // the size of the first block, each further one is at least twice as
+    // large as the one before
+    static const size_t BLOCK_BYTES = 64 << 10;
+
+    Arena() = default;
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // Frees everything allocated so far in constant time. Nothing allocated
+    // from the arena may be used afterwards.
+    void reset();
+    // Bytes handed out since the last reset, and reserved in all blocks.
+    size_t bytesUsed() const { return used; }
+    size_t capacity() const;
+};
+
+#endif // ARENA_H
@@ -0,0 +1,341 @@
+#include "arrow.hpp"
+#include "flatbuf.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// from the Arrow format definitions (Schema.fbs, Message.fbs, File.fbs)
+static const int16_t METADATA_V5 = 4;
+static const uint8_t HEADER_SCHEMA = 1;
+static const uint8_t HEADER_RECORD_BATCH = 3;
+static const uint8_t TYPE_BOOL = 6;
+static const int32_t CONTINUATION = -1;
+static const char MAGIC[6] = {'A', 'R', 'R', 'O', 'W', '1'};
+// buffers in a message body start at multiples of this
+static const size_t BODY_ALIGNMENT = 64;
+
+struct FieldNode {
+    int64_t length;
+    int64_t nullCount;
+};
+
+struct BufferRef {
+    int64_t offset;
+    int64_t length;
+};
+
+struct Block {
+    int64_t offset;
+    int32_t metaDataLength;
+    int32_t padding;
+    int64_t bodyLength;
+};
+
+static uint64_t alignUp(uint64_t n, uint64_t alignment) {
+    return (n + alignment - 1) / alignment * alignment;
+}
+
+static FlatTable schemaTable(const TruthTable& table) {
+    std::vector<std::string> names(table.getVariables());
+    names.push_back(table.getExpression());
+    std::vector<FlatTable> fields;
+    for (auto& name : names) {
+        FlatTable field;
+        field.string(0, name)
+            .scalar<uint8_t>(1, 0) // not nullable
+            .scalar<uint8_t>(2, TYPE_BOOL)
+            .table(3, FlatTable())
+            .tables(5, {});
+        fields.push_back(field);
+    }
+    FlatTable schema;
+    schema.scalar<int16_t>(0, 0) // little endian
+        .tables(1, fields);
+    return schema;
+}
+
+// Writes an encapsulated message (continuation marker, metadata length,
+// metadata padded to 8 bytes) and returns its block, minus the body.
+static Block writeMessage(OutputBuffer& out, uint64_t start,
+                          uint8_t headerType, const FlatTable& header,
+                          int64_t bodyLength) {
+    FlatTable message;
+    message.scalar<int16_t>(0, METADATA_V5)
+        .scalar<uint8_t>(1, headerType)
+        .table(2, header)
+        .scalar<int64_t>(3, bodyLength);
+    auto metadata = finishFlatBuffer(message);
+    metadata.resize(alignUp(metadata.size(), 8), '\0');
+
+    Block block{(int64_t)(out.bytesWritten() - start),
+                (int32_t)(8 + metadata.size()), 0, bodyLength};
+    int32_t length = metadata.size();
+    out.append(reinterpret_cast<const char*>(&CONTINUATION), 4);
+    out.append(reinterpret_cast<const char*>(&length), 4);
+    out.append(metadata);
+    return block;
+}
+
+static void pad(OutputBuffer& out, size_t bytes) {
+    static const char zeros[BODY_ALIGNMENT] = {};
+    out.append(zeros, bytes);
+}
+
+void writeArrow(TruthTable& table, OutputBuffer& out) {
+    const uint64_t start = out.bytesWritten();
+    out.append(MAGIC, sizeof(MAGIC));
+    pad(out, 2);
+    writeMessage(out, start, HEADER_SCHEMA, schemaTable(table), 0);
+
+    const size_t n = table.variableCount();
+    const uint64_t rows = table.rowCount();
+    const uint64_t batchRows = std::min(rows, ARROW_BATCH_ROWS);
+    std::vector<uint64_t> words((batchRows + 63) / 64);
+    std::vector<Block> blocks;
+    for (uint64_t first = 0; first < rows; first += batchRows) {
+        // every column gets an empty validity bitmap and a data buffer of
+        // whole words
+        const uint64_t firstWord = first / 64;
+        const uint64_t dataBytes = words.size() * sizeof(uint64_t);
+        const uint64_t padded = alignUp(dataBytes, BODY_ALIGNMENT);
+        std::vector<FieldNode> nodes;
+        std::vector<BufferRef> buffers;
+        for (size_t c = 0; c <= n; c++) {
+            nodes.push_back({(int64_t)batchRows, 0});
+            buffers.push_back({(int64_t)(c * padded), 0});
+            buffers.push_back({(int64_t)(c * padded), (int64_t)dataBytes});
+        }
+        FlatTable batch;
+        batch.scalar<int64_t>(0, batchRows).structs(1, nodes).structs(2,
+                                                                      buffers);
+        blocks.push_back(writeMessage(out, start, HEADER_RECORD_BATCH, batch,
+                                      (n + 1) * padded));
+
+        for (size_t i = 0; i < n; i++) {
+            for (size_t w = 0; w < words.size(); w++) {
+                words[w] = TruthTable::variableWord(i, n, firstWord + w);
+            }
+            out.append(reinterpret_cast<const char*>(words.data()), dataBytes);
+            pad(out, padded - dataBytes);
+        }
+        table.evaluate(firstWord, words.size(), words.data());
+        out.append(reinterpret_cast<const char*>(words.data()), dataBytes);
+        pad(out, padded - dataBytes);
+    }
+
+    // end of stream marker, then the footer
+    int32_t zero = 0;
+    out.append(reinterpret_cast<const char*>(&CONTINUATION), 4);
+    out.append(reinterpret_cast<const char*>(&zero), 4);
+    FlatTable footer;
+    footer.scalar<int16_t>(0, METADATA_V5)
+        .table(1, schemaTable(table))
+        .structs(2, std::vector<Block>())
+        .structs(3, blocks);
+    auto metadata = finishFlatBuffer(footer);
+    int32_t length = metadata.size();
+    out.append(metadata);
+    out.append(reinterpret_cast<const char*>(&length), 4);
+    out.append(MAGIC, sizeof(MAGIC));
+}
+
+ArrowFile::ArrowFile(const std::string& path) {
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("cannot open " + path + ": " +
+                                 std::strerror(errno));
+    }
+    struct stat st;
+    void* mapped = MAP_FAILED;
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+        size = st.st_size;
+        mapped = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    if (mapped == MAP_FAILED) {
+        auto error = std::runtime_error("cannot map " + path);
+        ::close(fd);
+        throw error;
+    }
+    base = static_cast<const uint8_t*>(mapped);
+    // the destructor does not run for a throwing constructor
+    try {
+        parse();
+    } catch (const std::runtime_error& e) {
+        ::munmap(const_cast<uint8_t*>(base), size);
+        ::close(fd);
+        throw std::runtime_error(path + ": " + e.what());
+    }
+}
+
+ArrowFile::~ArrowFile() {
+    ::munmap(const_cast<uint8_t*>(base), size);
+    ::close(fd);
+}
+
+void ArrowFile::parse() {
+    if (size < 8 + 4 + sizeof(MAGIC) || std::memcmp(base, MAGIC, 6) ||
+        std::memcmp(base + size - 6, MAGIC, 6)) {
+        throw std::runtime_error("not an Arrow file");
+    }
+    int32_t footerLength;
+    std::memcpy(&footerLength, base + size - 10, 4);
+    if (footerLength <= 0 || (size_t)footerLength > size - 18) {
+        throw std::runtime_error("malformed footer");
+    }
+    auto footer =
+        FlatView::root(base + size - 10 - footerLength, footerLength);
+
+    auto schema = footer.table(1);
+    size_t columns = schema.vectorLength(1);
+    if (columns == 0) {
+        throw std::runtime_error("no columns");
+    }
+    for (size_t c = 0; c < columns; c++) {
+        auto field = schema.tableAt(1, c);
+        auto name = field.has(0) ? field.string(0) : "";
+        if (field.scalar<uint8_t>(2, 0) != TYPE_BOOL) {
+            throw std::runtime_error("column `" + name + "` is not boolean");
+        }
+        if (c + 1 < columns) {
+            variables.push_back(name);
+        } else {
+            expression = name;
+        }
+    }
+
+    for (size_t b = 0; b < footer.vectorLength(3); b++) {
+        auto block = footer.structAt<Block>(3, b);
+        if (block.offset < 0 || block.metaDataLength < 8 ||
+            block.bodyLength < 0 || (uint64_t)block.offset > size ||
+            (uint64_t)block.metaDataLength > size - block.offset ||
+            (uint64_t)block.bodyLength >
+                size - block.offset - block.metaDataLength) {
+            throw std::runtime_error("record batch out of bounds");
+        }
+        // messages written before the continuation marker existed start
+        // with the metadata length
+        const uint8_t* message = base + block.offset;
+        int32_t prefix;
+        std::memcpy(&prefix, message, 4);
+        size_t skip = prefix == CONTINUATION ? 8 : 4;
+        auto header = FlatView::root(message + skip,
+                                     block.metaDataLength - skip);
+        if (header.scalar<uint8_t>(1, 0) != HEADER_RECORD_BATCH) {
+            throw std::runtime_error("expected a record batch");
+        }
+        auto batch = header.table(2);
+        if (batch.has(3)) {
+            throw std::runtime_error("compressed record batches are not "
+                                     "supported");
+        }
+        if (batch.vectorLength(1) != columns ||
+            batch.vectorLength(2) != 2 * columns) {
+            throw std::runtime_error("record batch does not match the schema");
+        }
+
+        Batch entry;
+        entry.firstRow = rows;
+        entry.rows = batch.scalar<int64_t>(0, 0);
+        const uint8_t* body = message + block.metaDataLength;
+        for (size_t c = 0; c < columns; c++) {
+            if (batch.structAt<FieldNode>(1, c).nullCount != 0) {
+                throw std::runtime_error("null values are not supported");
+            }
+            auto data = batch.structAt<BufferRef>(2, 2 * c + 1);
+            if (data.offset < 0 || data.length < 0 ||
+                data.offset > block.bodyLength ||
+                data.length > block.bodyLength - data.offset ||
+                (uint64_t)data.length < (entry.rows + 7) / 8) {
+                throw std::runtime_error("column buffer out of bounds");
+            }
+            entry.columns.push_back(body + data.offset);
+            entry.lengths.push_back(data.length);
+        }
+        rows += entry.rows;
+        if (entry.rows > 0) {
+            batches.push_back(entry);
+        }
+    }
+}
+
+const ArrowFile::Batch& ArrowFile::batchOf(uint64_t row) const {
+    auto it = std::upper_bound(
+        batches.begin(), batches.end(), row,
+        [](uint64_t r, const Batch& batch) { return r < batch.firstRow; });
+    return *(it - 1);
+}
+
+uint64_t ArrowFile::loadBits(const Batch& batch, size_t column, uint64_t row,
+                             size_t count) const {
+    uint64_t local = row - batch.firstRow;
+    uint64_t byte = local / 8;
+    size_t shift = local % 8;
+    // copies at most the 9 bytes holding the bits, without reading past the
+    // buffer
+    uint8_t bytes[16] = {};
+    std::memcpy(bytes, batch.columns[column] + byte,
+                std::min<uint64_t>(9, batch.lengths[column] - byte));
+    uint64_t low;
+    std::memcpy(&low, bytes, 8);
+    uint64_t bits = low >> shift;
+    if (shift) {
+        bits |= (uint64_t)bytes[8] << (64 - shift);
+    }
+    return count < 64 ? bits & ((1ull << count) - 1) : bits;
+}
+
+uint64_t ArrowFile::word(size_t column, uint64_t w) const {
+    uint64_t first = 64 * w;
+    if (first >= rows) {
+        return 0;
+    }
+    uint64_t total = std::min<uint64_t>(64, rows - first);
+    uint64_t bits = 0;
+    uint64_t filled = 0;
+    // the word may span batches of any length
+    while (filled < total) {
+        const auto& batch = batchOf(first + filled);
+        uint64_t take = std::min(total - filled,
+                                 batch.firstRow + batch.rows - first - filled);
+        bits |= loadBits(batch, column, first + filled, take) << filled;
+        filled += take;
+    }
+    return bits;
+}
+
+uint64_t ArrowFile::ones() const {
+    uint64_t count = 0;
+    for (uint64_t w = 0; w < wordCount(); w++) {
+        count += __builtin_popcountll(word(variables.size(), w));
+    }
+    return count;
+}
+
+uint64_t ArrowFile::compare(TruthTable& table,
+                            uint64_t& firstDifference) const {
+    if (table.getVariables() != variables || table.rowCount() != rows) {
+        throw std::runtime_error("tables are over different variables");
+    }
+    uint64_t differing = 0;
+    firstDifference = rows;
+    std::vector<uint64_t> fresh(TruthTable::BATCH_ROWS / 64);
+    const uint64_t total = wordCount();
+    for (uint64_t first = 0; first < total; first += fresh.size()) {
+        size_t count = std::min<uint64_t>(fresh.size(), total - first);
+        table.evaluate(first, count, fresh.data());
+        for (size_t w = 0; w < count; w++) {
+            uint64_t diff = fresh[w] ^ word(variables.size(), first + w);
+            if (diff == 0) {
+                continue;
+            }
+            if (differing == 0) {
+                firstDifference = 64 * (first + w) + __builtin_ctzll(diff);
+            }
+            differing += __builtin_popcountll(diff);
+        }
+    }
+    return differing;
+}
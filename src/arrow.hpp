@@ -0,0 +1,77 @@
+#ifndef ARROW_H
+#define ARROW_H
+
+#include "outbuf.hpp"
+#include "truthtable.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Apache Arrow IPC file format ("ARROW1" magic, a stream of encapsulated
+// messages and a footer indexing them), limited to what a truth table
+// needs: one non-nullable boolean column per variable plus one for the
+// result, split into record batches of up to ARROW_BATCH_ROWS rows. Arrow
+// booleans are bitmaps with row i in bit i % 8 of byte i / 8, which is
+// exactly the memory layout of the little endian words TruthTable packs, so
+// the column buffers are written as they come out of the evaluator.
+const uint64_t ARROW_BATCH_ROWS = 1 << 20;
+
+// Writes the table as a complete Arrow file.
+void writeArrow(TruthTable& table, OutputBuffer& out);
+
+// Read-only view of an Arrow file through mmap(2) holding boolean columns
+// without nulls, such as the ones written above. The last column is taken
+// as the result and the others as the variables.
+class ArrowFile {
+private:
+    struct Batch {
+        uint64_t firstRow;
+        uint64_t rows;
+        // data buffer and its length in bytes per column
+        std::vector<const uint8_t*> columns;
+        std::vector<uint64_t> lengths;
+    };
+
+    int fd = -1;
+    const uint8_t* base = nullptr;
+    size_t size = 0;
+    std::vector<std::string> variables;
+    std::string expression;
+    std::vector<Batch> batches;
+    uint64_t rows = 0;
+
+    void parse();
+    const Batch& batchOf(uint64_t row) const;
+    // up to 64 bits of a column starting at `row`, within one batch
+    uint64_t loadBits(const Batch& batch, size_t column, uint64_t row,
+                      size_t count) const;
+
+public:
+    // Throws std::runtime_error when the file cannot be mapped or is not an
+    // Arrow file of boolean columns.
+    ArrowFile(const std::string& path);
+    ~ArrowFile();
+    ArrowFile(const ArrowFile&) = delete;
+    ArrowFile& operator=(const ArrowFile&) = delete;
+
+    const std::vector<std::string>& getVariables() const { return variables; }
+    const std::string& getExpression() const { return expression; }
+    uint64_t rowCount() const { return rows; }
+    uint64_t wordCount() const { return (rows + 63) / 64; }
+    size_t fileSize() const { return size; }
+    size_t batchCount() const { return batches.size(); }
+
+    // Value in `column`, the result being column getVariables().size().
+    bool cell(size_t column, uint64_t row) const {
+        return loadBits(batchOf(row), column, row, 1);
+    }
+    bool row(uint64_t r) const { return cell(variables.size(), r); }
+    // Rows 64 * w to 64 * w + 63 of a column, zero past the last row.
+    uint64_t word(size_t column, uint64_t w) const;
+    // Rows in which the expression is true, counted over the whole column.
+    uint64_t ones() const;
+
+    uint64_t compare(TruthTable& table, uint64_t& firstDifference) const;
+};
+
+#endif // ARROW_H
@@ -0,0 +1,70 @@
+#include "ast.hpp"
+#include "symbols.hpp"
+#include <cstring>
+
+uint32_t Ast::add(AstNode node) {
+    nodes.push_back(node);
+    return nodes.size() - 1;
+}
+
+uint32_t Ast::addVariable(uint32_t symbol) {
+    return add(AstNode{TokenType::VARIABLE, symbol, 0, 0});
+}
+
+uint32_t Ast::addNegation(uint32_t operand) {
+    return add(AstNode{TokenType::NEGATION_OP, 0, operand, 0});
+}
+
+uint32_t Ast::addBinary(TokenType type, uint32_t left, uint32_t right) {
+    return add(AstNode{type, 0, left, right});
+}
+
+// Every subtree prints as one contiguous piece, so the length of each
+// piece is worked out bottom up (operands come first), then each node writes
+// its parentheses and operator at its place top down, neither pass needing
+// recursion or a stack.
+void Ast::printInfix(std::string& out) const {
+    if (nodes.empty()) {
+        return;
+    }
+    std::pmr::vector<size_t> length(nodes.size(), nodes.get_allocator());
+    std::pmr::vector<size_t> start(nodes.size(), nodes.get_allocator());
+    for (size_t i = 0; i < nodes.size(); i++) {
+        auto& node = nodes[i];
+        if (node.type == TokenType::VARIABLE) {
+            length[i] = names->name(node.symbol).size();
+        } else if (node.type == TokenType::NEGATION_OP) {
+            // !(operand)
+            length[i] = 3 + length[node.left];
+        } else {
+            // (left op right)
+            length[i] = 5 + length[node.left] + length[node.right];
+        }
+    }
+
+    start[root()] = out.size();
+    out.resize(out.size() + length[root()]);
+    char* text = out.data();
+    for (size_t i = nodes.size(); i-- > 0;) {
+        auto& node = nodes[i];
+        char* at = text + start[i];
+        if (node.type == TokenType::VARIABLE) {
+            auto& name = names->name(node.symbol);
+            std::memcpy(at, name.data(), name.size());
+        } else if (node.type == TokenType::NEGATION_OP) {
+            at[0] = '!';
+            at[1] = '(';
+            at[length[i] - 1] = ')';
+            start[node.left] = start[i] + 2;
+        } else {
+            const size_t middle = 1 + length[node.left];
+            at[0] = '(';
+            at[middle] = ' ';
+            at[middle + 1] = TOKEN_TRAITS[(int)node.type].text[0];
+            at[middle + 2] = ' ';
+            at[length[i] - 1] = ')';
+            start[node.left] = start[i] + 1;
+            start[node.right] = start[i] + middle + 3;
+        }
+    }
+}
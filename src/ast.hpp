@@ -0,0 +1,51 @@
+#ifndef AST_H
+#define AST_H
+
+#include "symbols.hpp"
+#include "tokens.hpp"
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+// A node of an expression: a variable, a negation of `left` or a binary
+// operator applied to `left` and `right`.
+struct AstNode {
+    TokenType type;
+    uint32_t symbol; // variables only, see Ast::getSymbols()
+    uint32_t left;
+    uint32_t right;
+};
+
+// The syntax tree of an expression. Nodes live in one vector and refer to
+// each other by index, and every node comes after its operands, so the
+// vector in order is the postfix form of the expression and the root is
+// the last node.
+class Ast {
+private:
+    std::pmr::vector<AstNode> nodes;
+    const SymbolTable* names;
+
+    uint32_t add(AstNode node);
+
+public:
+    // Variable symbols are ids in `names`, the table the tokens were lexed
+    // into.
+    Ast(std::pmr::memory_resource* memory = std::pmr::get_default_resource(),
+        const SymbolTable& names = symbols())
+        : nodes(memory), names(&names) {}
+    void reserve(size_t count) { nodes.reserve(count); }
+    uint32_t addVariable(uint32_t symbol);
+    uint32_t addNegation(uint32_t operand);
+    uint32_t addBinary(TokenType type, uint32_t left, uint32_t right);
+
+    const std::pmr::vector<AstNode>& getNodes() const { return nodes; }
+    const SymbolTable& getSymbols() const { return *names; }
+    uint32_t root() const { return nodes.size() - 1; }
+
+    // Appends the expression with every operation in parentheses, such as
+    // ((a & !(b)) | c), in time linear in the length of the result.
+    void printInfix(std::string& out) const;
+};
+
+#endif // AST_H
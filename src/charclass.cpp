@@ -0,0 +1,159 @@
+#include "charclass.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CHARCLASS_X86 1
+#endif
+
+enum : uint8_t {
+    SPACE = 1,
+    IDENT = 2,
+    DIGIT = 4,
+    BINARY = 8,
+    NEGATION = 16,
+    LPAREN = 32,
+    RPAREN = 64,
+};
+
+struct ClassTable {
+    uint8_t of[256] = {};
+
+    constexpr ClassTable() {
+        for (int c = '\t'; c <= '\r'; c++) {
+            of[c] = SPACE;
+        }
+        of[(int)' '] = SPACE;
+        for (int c = 'a'; c <= 'z'; c++) {
+            of[c] = IDENT;
+        }
+        for (int c = '0'; c <= '9'; c++) {
+            of[c] = IDENT | DIGIT;
+        }
+        of[(int)'_'] = IDENT;
+        of[(int)'|'] = BINARY;
+        of[(int)'&'] = BINARY;
+        of[(int)'^'] = BINARY;
+        of[(int)'>'] = BINARY;
+        of[(int)'='] = BINARY;
+        of[(int)'!'] = NEGATION;
+        of[(int)'('] = LPAREN;
+        of[(int)')'] = RPAREN;
+    }
+};
+
+static constexpr ClassTable CLASSES;
+
+static void classifyScalar(const char* block, CharClasses& classes) {
+    classes = CharClasses{};
+    for (int i = 0; i < 64; i++) {
+        const uint64_t bit = 1ull << i;
+        const uint8_t c = CLASSES.of[(unsigned char)block[i]];
+        classes.space |= c & SPACE ? bit : 0;
+        classes.ident |= c & IDENT ? bit : 0;
+        classes.digit |= c & DIGIT ? bit : 0;
+        classes.binary |= c & BINARY ? bit : 0;
+        classes.negation |= c & NEGATION ? bit : 0;
+        classes.lparen |= c & LPAREN ? bit : 0;
+        classes.rparen |= c & RPAREN ? bit : 0;
+    }
+}
+
+#ifdef CHARCLASS_X86
+// Bytes are compared as signed, so bytes above 127 fall in no range.
+__attribute__((target("sse2"))) static inline uint64_t
+sse2Equal(__m128i v, char c) {
+    return (uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(c)));
+}
+
+__attribute__((target("sse2"))) static inline uint64_t
+sse2Range(__m128i v, char low, char high) {
+    __m128i in = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(low - 1)),
+                               _mm_cmpgt_epi8(_mm_set1_epi8(high + 1), v));
+    return (uint16_t)_mm_movemask_epi8(in);
+}
+
+__attribute__((target("sse2"))) static void
+classifySse2(const char* block, CharClasses& classes) {
+    classes = CharClasses{};
+    for (int i = 0; i < 64; i += 16) {
+        __m128i v =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i));
+        uint64_t digit = sse2Range(v, '0', '9');
+        classes.space |=
+            (sse2Equal(v, ' ') | sse2Range(v, '\t', '\r')) << i;
+        classes.ident |=
+            (sse2Range(v, 'a', 'z') | digit | sse2Equal(v, '_')) << i;
+        classes.digit |= digit << i;
+        classes.binary |= (sse2Equal(v, '|') | sse2Equal(v, '&') |
+                           sse2Equal(v, '^') | sse2Equal(v, '>') |
+                           sse2Equal(v, '='))
+                          << i;
+        classes.negation |= sse2Equal(v, '!') << i;
+        classes.lparen |= sse2Equal(v, '(') << i;
+        classes.rparen |= sse2Equal(v, ')') << i;
+    }
+}
+
+__attribute__((target("avx2"))) static inline uint64_t
+avx2Equal(__m256i v, char c) {
+    return (uint32_t)_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(v, _mm256_set1_epi8(c)));
+}
+
+__attribute__((target("avx2"))) static inline uint64_t
+avx2Range(__m256i v, char low, char high) {
+    __m256i in =
+        _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(low - 1)),
+                         _mm256_cmpgt_epi8(_mm256_set1_epi8(high + 1), v));
+    return (uint32_t)_mm256_movemask_epi8(in);
+}
+
+__attribute__((target("avx2"))) static void
+classifyAvx2(const char* block, CharClasses& classes) {
+    classes = CharClasses{};
+    for (int i = 0; i < 64; i += 32) {
+        __m256i v =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + i));
+        uint64_t digit = avx2Range(v, '0', '9');
+        classes.space |=
+            (avx2Equal(v, ' ') | avx2Range(v, '\t', '\r')) << i;
+        classes.ident |=
+            (avx2Range(v, 'a', 'z') | digit | avx2Equal(v, '_')) << i;
+        classes.digit |= digit << i;
+        classes.binary |= (avx2Equal(v, '|') | avx2Equal(v, '&') |
+                           avx2Equal(v, '^') | avx2Equal(v, '>') |
+                           avx2Equal(v, '='))
+                          << i;
+        classes.negation |= avx2Equal(v, '!') << i;
+        classes.lparen |= avx2Equal(v, '(') << i;
+        classes.rparen |= avx2Equal(v, ')') << i;
+    }
+}
+#endif
+
+using Kernel = void (*)(const char*, CharClasses&);
+
+static Kernel pickKernel(const char** name) {
+#ifdef CHARCLASS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        *name = "avx2";
+        return classifyAvx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        *name = "sse2";
+        return classifySse2;
+    }
+#endif
+    *name = "scalar";
+    return classifyScalar;
+}
+
+static const char* kernelName = nullptr;
+static const Kernel kernel = pickKernel(&kernelName);
+
+void classifyBlock(const char* block, CharClasses& classes) {
+    kernel(block, classes);
+}
+
+const char* classifyKernel() { return kernelName; }
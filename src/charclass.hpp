@@ -0,0 +1,36 @@
+#ifndef CHARCLASS_H
+#define CHARCLASS_H
+
+#include <cstdint>
+
+// The bytes of a block of 64 bytes of an expression in each character
+// class the lexer cares about, bit i standing for byte i.
+struct CharClasses {
+    uint64_t space;    // the characters std::isspace accepts
+    uint64_t ident;    // a-z, 0-9 and _
+    uint64_t digit;    // 0-9
+    uint64_t binary;   // | & ^ > =
+    uint64_t negation; // !
+    uint64_t lparen;
+    uint64_t rparen;
+};
+
+// Classifies the 64 bytes at `block`. Uses AVX2 or SSE2 when the CPU has
+// them.
+void classifyBlock(const char* block, CharClasses& classes);
+
+// The kernel classifyBlock() runs: "avx2", "sse2" or "scalar".
+const char* classifyKernel();
+
+// Bit i of the result is the parity of bits 0 to i of `x`.
+inline uint64_t prefixXor(uint64_t x) {
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+#endif // CHARCLASS_H
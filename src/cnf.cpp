@@ -0,0 +1,70 @@
+#include "cnf.hpp"
+#include <algorithm>
+
+CnfEncoder::CnfEncoder(const AIG& aig, Solver& solver)
+    : aig(aig), solver(solver) {}
+
+SatLit CnfEncoder::literal(AigLit lit) {
+    if (nodeVars.size() < aig.nodeCount()) {
+        nodeVars.resize(aig.nodeCount(), UINT32_MAX);
+    }
+
+    auto root = aigNode(lit);
+    if (!isEncoded(root)) {
+        // collect the unencoded part of the cone, then encode it bottom up;
+        // node indices are topological so sorting them is enough
+        std::vector<uint32_t> pending{root};
+        std::vector<uint32_t> cone;
+        nodeVars[root] = UINT32_MAX - 1;
+        while (!pending.empty()) {
+            auto idx = pending.back();
+            pending.pop_back();
+            cone.push_back(idx);
+            if (!aig.isAnd(idx)) {
+                continue;
+            }
+            for (auto fanin : {aig.node(idx).fanin0, aig.node(idx).fanin1}) {
+                auto child = aigNode(fanin);
+                if (nodeVars[child] == UINT32_MAX) {
+                    nodeVars[child] = UINT32_MAX - 1;
+                    pending.push_back(child);
+                }
+            }
+        }
+        std::sort(cone.begin(), cone.end());
+
+        for (auto idx : cone) {
+            auto var = solver.newVar();
+            nodeVars[idx] = var;
+            auto out = satMakeLit(var);
+            if (idx == 0) {
+                solver.addClause({satNot(out)});
+            } else if (aig.isAnd(idx)) {
+                const auto& node = aig.node(idx);
+                auto a = satMakeLit(nodeVars[aigNode(node.fanin0)],
+                                    aigIsComplemented(node.fanin0));
+                auto b = satMakeLit(nodeVars[aigNode(node.fanin1)],
+                                    aigIsComplemented(node.fanin1));
+                solver.addClause({satNot(out), a});
+                solver.addClause({satNot(out), b});
+                solver.addClause({out, satNot(a), satNot(b)});
+            }
+        }
+    }
+    return satMakeLit(nodeVars[root], aigIsComplemented(lit));
+}
+
+SatResult CnfEncoder::checkEquivalence(AigLit a, AigLit b) {
+    auto litA = literal(a);
+    auto litB = literal(b);
+    for (auto assumptions : {std::vector<SatLit>{litA, satNot(litB)},
+                             std::vector<SatLit>{satNot(litA), litB}}) {
+        auto result = solver.solve(assumptions);
+        if (result != SatResult::UNSATISFIABLE) {
+            return result;
+        }
+    }
+    solver.addClause({satNot(litA), litB});
+    solver.addClause({litA, satNot(litB)});
+    return SatResult::UNSATISFIABLE;
+}
@@ -0,0 +1,34 @@
+#ifndef CNF_H
+#define CNF_H
+
+#include "aig.hpp"
+#include "solver.hpp"
+#include <vector>
+
+// Tseitin encoding of AIG nodes into a solver. Nodes are encoded lazily, the
+// first time a literal in their cone is requested, so an AIG that keeps
+// growing can feed one incremental solver.
+class CnfEncoder {
+private:
+    const AIG& aig;
+    Solver& solver;
+    std::vector<uint32_t> nodeVars;
+
+public:
+    CnfEncoder(const AIG& aig, Solver& solver);
+
+    SatLit literal(AigLit lit);
+    bool isEncoded(uint32_t node) const {
+        return node < nodeVars.size() && nodeVars[node] != UINT32_MAX;
+    }
+    // Decides a == b with two incremental calls under assumptions, one per
+    // direction of the difference, leaving a distinguishing assignment in
+    // the solver's model when they differ. Proven equivalences are kept as
+    // clauses to help later calls.
+    SatResult checkEquivalence(AigLit a, AigLit b);
+
+    // Solver variable of an encoded node.
+    uint32_t nodeVar(uint32_t node) const { return nodeVars[node]; }
+};
+
+#endif // CNF_H
@@ -0,0 +1,1186 @@
+#include "commands.hpp"
+#include "aiger.hpp"
+#include "alloccount.hpp"
+#include "arena.hpp"
+#include "arrow.hpp"
+#include "charclass.hpp"
+#include "compress.hpp"
+#include "constants.hpp"
+#include "equivalence.hpp"
+#include "export.hpp"
+#include "fraig.hpp"
+#include "ingest.hpp"
+#include "interpreter.hpp"
+#include "lexer.hpp"
+#include "pager.hpp"
+#include "parser.hpp"
+#include "portfolio.hpp"
+#include "renderer.hpp"
+#include "simulator.hpp"
+#include "stringutils.hpp"
+#include "tablefile.hpp"
+#include "tabulate.hpp"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+
+static void printError(const std::string& message) {
+    std::cout << red(message) << std::endl;
+}
+
+static std::string formatRate(double perSecond) {
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(1);
+    if (perSecond >= 1e9) {
+        ss << perSecond / 1e9 << " G";
+    } else if (perSecond >= 1e6) {
+        ss << perSecond / 1e6 << " M";
+    } else if (perSecond >= 1e3) {
+        ss << perSecond / 1e3 << " K";
+    } else {
+        ss << perSecond << " ";
+    }
+    return ss.str();
+}
+
+// Tokenizes an expression the way the REPL does. The result is empty (and
+// the lexer has reported why) when the expression is invalid.
+static TokenList tokenizeExpression(std::string expr) {
+    trim(expr);
+    std::transform(expr.begin(), expr.end(), expr.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    auto lexer = Lexer(expr);
+    auto tokens = lexer.tokenize();
+    lexer.reportDiagnostics();
+    return tokens;
+}
+
+// Lowers an expression into the AIG, returning false (after the lexer
+// reported why) when it is invalid.
+static bool lowerExpression(std::string expr, AIG& aig, AigLit& root) {
+    auto tokens = tokenizeExpression(expr);
+    if (tokens.size() == 0) {
+        return false;
+    }
+    root = Interpreter(tokens).buildAIG(aig);
+    return true;
+}
+
+// Simulates `rounds` batches of random patterns and returns the number of
+// patterns evaluated per second. When `ones` is given, it accumulates the
+// number of patterns setting each output to true.
+static double simulateRandom(const AigerCircuit& circuit, size_t words,
+                             size_t rounds, std::vector<size_t>* ones) {
+    Simulator sim(circuit.aig, words);
+    std::mt19937_64 rng(0x9e3779b97f4a7c15ull);
+    std::chrono::duration<double> elapsed(0);
+    for (size_t r = 0; r < rounds; r++) {
+        sim.randomizeInputs(rng);
+        auto start = std::chrono::steady_clock::now();
+        sim.run();
+        elapsed += std::chrono::steady_clock::now() - start;
+        if (ones) {
+            for (size_t o = 0; o < circuit.outputs.size(); o++) {
+                (*ones)[o] += sim.countOnes(circuit.outputs[o]);
+            }
+        }
+    }
+    return rounds * sim.patternCount() / std::max(elapsed.count(), 1e-9);
+}
+
+// the most random patterns /aiger simulates
+static const int64_t AIGER_MAX_PATTERNS = int64_t(1) << 30;
+
+void aigerCommand(const std::string& args) {
+    std::istringstream ss(args);
+    std::string path;
+    int64_t patterns = 1 << 16;
+    if (!(ss >> path)) {
+        printError("usage: /aiger <file> [patterns]");
+        return;
+    }
+    // a signed count, so that a negative one is not wrapped around
+    if (!(ss >> std::ws).eof() &&
+        (!(ss >> patterns) || !(ss >> std::ws).eof())) {
+        patterns = 0;
+    }
+    if (patterns <= 0 || patterns > AIGER_MAX_PATTERNS) {
+        printError("pattern count must be a number from 1 to " +
+                   std::to_string(AIGER_MAX_PATTERNS));
+        return;
+    }
+
+    AigerCircuit circuit;
+    try {
+        circuit = readAiger(path);
+    } catch (const std::exception& e) {
+        printError(e.what());
+        return;
+    }
+
+    const auto& aig = circuit.aig;
+    uint32_t depth = 0;
+    for (auto lit : circuit.outputs) {
+        depth = std::max(depth, aig.depth(lit));
+    }
+    std::cout << purple(path) << ": " << aig.inputCount() << " inputs, "
+              << circuit.outputs.size() << " outputs, " << aig.andCount()
+              << " and nodes (" << circuit.declaredAnds << " declared), depth "
+              << depth << std::endl;
+
+    // 256 patterns per pass for the probabilities, 64 wide for comparison
+    size_t rounds = std::max<size_t>(1, (patterns + 255) / 256);
+    std::vector<size_t> ones(circuit.outputs.size(), 0);
+    double rate256 = simulateRandom(circuit, 4, rounds, &ones);
+    double rate64 = simulateRandom(circuit, 1, rounds * 4, nullptr);
+    double total = rounds * 256.0;
+
+    tabulate::Table table;
+    table.add_row({"output", "P(true)", "note"});
+    table.row(0).format().font_style({tabulate::FontStyle::bold});
+    for (size_t o = 0; o < circuit.outputs.size(); o++) {
+        auto lit = circuit.outputs[o];
+        std::string note;
+        if (lit == AIG_FALSE || lit == AIG_TRUE) {
+            note = lit == AIG_TRUE ? "constant true" : "constant false";
+        } else if (ones[o] == 0) {
+            note = "constant false candidate";
+        } else if (ones[o] == total) {
+            note = "constant true candidate";
+        }
+        std::stringstream probability;
+        probability << std::fixed << std::setprecision(6) << ones[o] / total;
+        table.add_row({circuit.outputNames[o], probability.str(), note});
+    }
+    std::cout << table << std::endl;
+
+    std::cout << yellow("simulated " + std::to_string((size_t)total) +
+                        " random patterns: " + formatRate(rate256) +
+                        "patterns/s (256 wide), " + formatRate(rate64) +
+                        "patterns/s (64 wide)")
+              << std::endl;
+}
+
+void fraigCommand(const std::string& args) {
+    auto start = std::chrono::steady_clock::now();
+    AIG aig;
+    std::vector<AigLit> left, right;
+    std::vector<std::string> labels;
+
+    if (args.find(',') != std::string::npos) {
+        std::vector<AigLit> roots;
+        ListSplitter expressions(args);
+        for (std::string_view expr; expressions.next(expr);) {
+            AigLit root;
+            if (!lowerExpression(std::string(expr), aig, root)) {
+                return;
+            }
+            roots.push_back(root);
+            labels.emplace_back(expr);
+        }
+        for (size_t i = 1; i < roots.size(); i++) {
+            left.push_back(roots[0]);
+            right.push_back(roots[i]);
+        }
+        labels.erase(labels.begin());
+    } else {
+        std::istringstream ss(args);
+        std::string pathA, pathB, rest;
+        if (!(ss >> pathA >> pathB) || (ss >> rest)) {
+            printError("usage: /fraig <file> <file> or /fraig <expr>, <expr>");
+            return;
+        }
+        AigerCircuit a, b;
+        try {
+            a = readAiger(pathA);
+            b = readAiger(pathB);
+        } catch (const std::exception& e) {
+            printError(e.what());
+            return;
+        }
+        if (a.aig.inputCount() != b.aig.inputCount() ||
+            a.outputs.size() != b.outputs.size()) {
+            printError("circuits differ in their number of inputs or outputs");
+            return;
+        }
+        left = aig.append(a.aig, a.outputs);
+        right = aig.append(b.aig, b.outputs);
+        labels = a.outputNames;
+    }
+
+    std::vector<AigLit> roots(left);
+    roots.insert(roots.end(), right.begin(), right.end());
+    Fraig fraig(aig);
+    fraig.sweep(roots);
+
+    bool equivalent = true;
+    for (size_t i = 0; i < left.size() && equivalent; i++) {
+        std::vector<bool> counterexample;
+        if (fraig.equivalent(left[i], right[i], counterexample)) {
+            continue;
+        }
+        equivalent = false;
+        std::stringstream ss;
+        for (size_t in = 0; in < counterexample.size(); in++) {
+            ss << " " << aig.inputName(in) << "=" << counterexample[in];
+        }
+        std::cout << red("NOT equivalent: `" + labels[i] + "` differs for") +
+                         ss.str()
+                  << std::endl;
+    }
+    if (equivalent) {
+        std::cout << green("equivalent") << std::endl;
+    }
+
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    const auto& stats = fraig.getStats();
+    std::stringstream ss;
+    ss << "fraig: " << stats.andsBefore << " -> " << stats.andsAfter
+       << " and nodes, " << stats.proven << " proven, " << stats.structural
+       << " structural, " << stats.refuted << " refuted, " << stats.undecided
+       << " undecided merges, " << stats.satCalls << " SAT calls, "
+       << std::fixed << std::setprecision(3) << elapsed.count() << "s";
+    std::cout << yellow(ss.str()) << std::endl;
+}
+
+void satCommand(const std::string& args) {
+    size_t solvers = std::max(1u, std::thread::hardware_concurrency());
+    std::string expr = args;
+    if (expr.rfind("-j", 0) == 0) {
+        std::istringstream ss(expr.substr(2));
+        if (!(ss >> solvers) || solvers == 0) {
+            printError("usage: /sat [-j <solvers>] <expr>");
+            return;
+        }
+        std::getline(ss, expr);
+    }
+    trim(expr);
+    if (expr.empty()) {
+        printError("usage: /sat [-j <solvers>] <expr>");
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    AIG aig;
+    AigLit root;
+    if (!lowerExpression(expr, aig, root)) {
+        return;
+    }
+    auto portfolio = solvePortfolio(aig, root, solvers);
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    if (portfolio.result == SatResult::SATISFIABLE) {
+        std::string values;
+        for (auto i : aig.support({root})) {
+            values += " " + aig.inputName(i) + "=" +
+                      (portfolio.inputValues[i] ? "true" : "false");
+        }
+        std::cout << green("satisfiable") + " for" + values << std::endl;
+    } else {
+        std::cout << red("unsatisfiable: `" + expr + "` is a contradiction")
+                  << std::endl;
+    }
+
+    const auto& stats = portfolio.stats[portfolio.winner];
+    std::stringstream ss;
+    ss << "portfolio: " << solvers << " solvers, #" << portfolio.winner << " ("
+       << describeOptions(portfolio.options[portfolio.winner])
+       << ") finished first after " << stats.conflicts << " conflicts, "
+       << portfolio.sharedClauses << " clauses shared, " << std::fixed
+       << std::setprecision(3) << elapsed.count() << "s";
+    std::cout << yellow(ss.str()) << std::endl;
+}
+
+void exportCommand(const std::string& args) {
+    std::istringstream ss(args);
+    std::string formatName, path, expr;
+    ExportFormat format;
+    ss >> formatName >> path;
+    std::getline(ss, expr);
+    trim(expr);
+    if (expr.empty()) {
+        printError("usage: /export <csv|md|jsonl|arrow|bits> <file> <expr>");
+        return;
+    }
+    std::transform(formatName.begin(), formatName.end(), formatName.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    if (!parseExportFormat(formatName, format)) {
+        printError("unknown format `" + formatName +
+                   "`, expected csv, md, jsonl, arrow or bits");
+        return;
+    }
+
+    auto tokens = tokenizeExpression(expr);
+    if (tokens.size() == 0) {
+        return;
+    }
+    auto interpreter = Interpreter(tokens);
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t rows = 0;
+    size_t bytes = 0;
+    bool toStdout = path == "-";
+    int fd = toStdout ? STDOUT_FILENO : -1;
+    std::cout.flush();
+    try {
+        // built before the file is opened, so that an expression the table
+        // rejects leaves an existing file as it was
+        TruthTable table(interpreter);
+        if (!toStdout) {
+            fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (fd < 0) {
+                printError("cannot open " + path + ": " +
+                           std::strerror(errno));
+                return;
+            }
+        }
+        OutputBuffer out(fd);
+        exportTable(table, format, out);
+        out.flush();
+        rows = table.rowCount();
+        bytes = out.bytesWritten();
+    } catch (const std::exception& e) {
+        if (!toStdout && fd >= 0) {
+            ::close(fd);
+        }
+        printError(e.what());
+        return;
+    }
+    if (!toStdout && ::close(fd) != 0) {
+        printError("cannot write " + path + ": " + std::strerror(errno));
+        return;
+    }
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    std::stringstream summary;
+    summary << "wrote " << rows << " rows, " << formatRate(bytes) << "B in "
+            << std::fixed << std::setprecision(3) << elapsed.count() << "s ("
+            << formatRate(bytes / std::max(elapsed.count(), 1e-9)) << "B/s)";
+    if (toStdout) {
+        std::cout << yellow(summary.str()) << std::endl;
+    } else {
+        std::cout << purple(path) << ": " << yellow(summary.str()) << std::endl;
+    }
+}
+
+void pageCommand(const std::string& args) {
+    std::string expr(args);
+    trim(expr);
+    if (expr.empty()) {
+        printError("usage: /page <expr>");
+        return;
+    }
+    auto tokens = tokenizeExpression(expr);
+    if (tokens.size() == 0) {
+        return;
+    }
+    auto interpreter = Interpreter(tokens);
+
+    std::cout.flush();
+    try {
+        TruthTable table(interpreter);
+        Pager pager(table);
+        pager.run();
+    } catch (const std::exception& e) {
+        printError(e.what());
+    }
+}
+
+// rows shown at each end of the table by default
+static const uint64_t SUMMARY_ROWS = 5;
+
+// Prints rows [first, last) the way the REPL prints tables: through the table
+// templates on a terminal (tabulate when they cannot lay the table out) and
+// as plain rows otherwise.
+static void printRows(TruthTable& table, uint64_t first, uint64_t last,
+                      bool header, OutputBuffer& out) {
+    if (!isatty(STDOUT_FILENO)) {
+        exportRows(table, ExportFormat::BITS, first, last, header, out);
+        return;
+    }
+    TableRenderer renderer(table.getVariables(), table.getExpression(), true);
+    if (renderer.isValid()) {
+        renderer.renderRows(table, first, last, header, out);
+        return;
+    }
+    const size_t n = table.variableCount();
+    std::vector<uint64_t> words((last - 1) / 64 - first / 64 + 1);
+    table.evaluate(first / 64, words.size(), words.data());
+    std::vector<std::vector<bool>> rows;
+    for (uint64_t row = first; row < last; row++) {
+        std::vector<bool> cells;
+        for (size_t i = 0; i < n; i++) {
+            cells.push_back(TruthTable::variableValue(i, n, row));
+        }
+        cells.push_back((words[row / 64 - first / 64] >> (row % 64)) & 1);
+        rows.push_back(cells);
+    }
+    std::stringstream ss;
+    ss << makeTruthTable(table.getVariables(), table.getExpression(), rows)
+       << "\n";
+    out.append(ss.str());
+}
+
+void summaryCommand(const std::string& args) {
+    int64_t shown = SUMMARY_ROWS;
+    std::string expr = args;
+    if (expr.rfind("-n", 0) == 0) {
+        std::istringstream ss(expr.substr(2));
+        if (!(ss >> shown) || shown < 0) {
+            printError("usage: /summary [-n <rows>] <expr>");
+            return;
+        }
+        std::getline(ss, expr);
+    }
+    trim(expr);
+    if (expr.empty()) {
+        printError("usage: /summary [-n <rows>] <expr>");
+        return;
+    }
+    auto tokens = tokenizeExpression(expr);
+    if (tokens.size() == 0) {
+        return;
+    }
+    auto interpreter = Interpreter(tokens);
+
+    try {
+        TruthTable table(interpreter);
+        const uint64_t rows = table.rowCount();
+
+        // one streaming pass counts the true rows and finds the first and
+        // the last of them
+        auto start = std::chrono::steady_clock::now();
+        uint64_t ones = 0, firstTrue = rows, lastTrue = rows;
+        std::vector<uint64_t> words(TruthTable::BATCH_ROWS / 64);
+        for (uint64_t w = 0; w < table.wordCount(); w += words.size()) {
+            size_t count = std::min<uint64_t>(words.size(), table.wordCount() - w);
+            table.evaluate(w, count, words.data());
+            for (size_t i = 0; i < count; i++) {
+                if (words[i] == 0) {
+                    continue;
+                }
+                ones += __builtin_popcountll(words[i]);
+                if (firstTrue == rows) {
+                    firstTrue = 64 * (w + i) + __builtin_ctzll(words[i]);
+                }
+                lastTrue = 64 * (w + i) + 63 - __builtin_clzll(words[i]);
+            }
+        }
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+
+        std::cout.flush();
+        {
+            OutputBuffer out(STDOUT_FILENO);
+            if (2 * (uint64_t)shown >= rows) {
+                printRows(table, 0, rows, true, out);
+            } else {
+                if (shown > 0) {
+                    printRows(table, 0, shown, true, out);
+                }
+                out.append(yellow("... " + std::to_string(rows - 2 * shown) +
+                                  " rows omitted ...") +
+                           "\n");
+                if (shown > 0) {
+                    printRows(table, rows - shown, rows, false, out);
+                }
+            }
+            out.flush();
+        }
+
+        std::stringstream ss;
+        ss << rows << " rows, " << ones << " true (" << std::fixed
+           << std::setprecision(2) << 100.0 * ones / rows << "%), "
+           << rows - ones << " false";
+        if (ones > 0) {
+            ss << ", first true row " << firstTrue << ", last true row "
+               << lastTrue;
+        }
+        ss << ", counted in " << std::setprecision(3) << elapsed.count()
+           << "s";
+        std::cout << yellow(ss.str()) << std::endl;
+        if (ones == rows) {
+            std::cout << yellow("`" + table.getExpression() +
+                                "` is a tautology")
+                      << std::endl;
+        } else if (ones == 0) {
+            std::cout << yellow("`" + table.getExpression() +
+                                "` is a contradiction")
+                      << std::endl;
+        }
+    } catch (const std::exception& e) {
+        printError(e.what());
+    }
+}
+
+// tables of up to this many rows are also timed through tabulate, which
+// gets slow long before the other outputs do
+static const uint64_t BENCH_TABULATE_ROWS = 1 << 12;
+static const int64_t BENCH_PARSE_MEGABYTES = 16;
+
+// Generates an expression of about `bytes` bytes over `variables` variables
+// (a thousand by default), with negations and parentheses, the same one
+// every time. A long one nests at most 64 deep, a deep one opens a
+// parenthesis at every operator.
+static std::string generateExpression(size_t bytes, bool deep,
+                                      size_t variables = 1000) {
+    static const char* OPERATORS[] = {" & ", " | ", " ^ ", " > ", " = "};
+    std::mt19937_64 rng(0x9e3779b97f4a7c15ull);
+    std::string expr;
+    expr.reserve(bytes + 64);
+    size_t depth = 0;
+    while (true) {
+        while (!deep && depth < 64 && rng() % 4 == 0) {
+            expr += rng() % 2 ? "!(" : "(";
+            depth++;
+        }
+        if (rng() % 3 == 0) {
+            expr += '!';
+        }
+        expr += "x" + std::to_string(rng() % variables);
+        while (!deep && depth > 0 && rng() % 3 == 0) {
+            expr += ')';
+            depth--;
+        }
+        if (expr.size() >= bytes) {
+            break;
+        }
+        expr += OPERATORS[rng() % 5];
+        if (deep) {
+            expr += '(';
+            depth++;
+        }
+    }
+    expr.append(depth, ')');
+    return expr;
+}
+
+// /bench --parse: tokenizes, parses and prints back a long and a deeply
+// nested generated expression, reporting the throughput of each stage.
+static void benchParse(const std::string& args) {
+    int64_t megabytes = BENCH_PARSE_MEGABYTES;
+    std::istringstream ss(args);
+    std::string rest;
+    if ((!args.empty() && !(ss >> megabytes)) || (ss >> rest) ||
+        megabytes <= 0) {
+        printError("usage: /bench --parse [<megabytes>]");
+        return;
+    }
+
+    tabulate::Table results;
+    results.add_row({"stage", "input", "time", "bytes", "tokens"});
+    results.row(0).format().font_style({tabulate::FontStyle::bold});
+    for (bool deep : {false, true}) {
+        auto expr = generateExpression(megabytes << 20, deep);
+        size_t tokenCount = 0;
+        auto measure = [&](const std::string& name,
+                           const std::function<void()>& run) {
+            auto start = std::chrono::steady_clock::now();
+            run();
+            std::chrono::duration<double> elapsed =
+                std::chrono::steady_clock::now() - start;
+            std::stringstream seconds;
+            seconds << std::fixed << std::setprecision(3) << elapsed.count()
+                    << "s";
+            double perSecond = 1 / std::max(elapsed.count(), 1e-9);
+            results.add_row(
+                {name + (deep ? ", deep" : ", long"),
+                 formatRate(expr.size()) + "B", seconds.str(),
+                 formatRate(expr.size() * perSecond) + "B/s",
+                 formatRate(tokenCount * perSecond) + "tokens/s"});
+        };
+
+        TokenList tokens;
+        measure("lexer", [&] {
+            Lexer lexer(expr);
+            tokens = lexer.tokenize();
+            tokenCount = tokens.size();
+        });
+        if (tokens.empty()) {
+            printError("the generated expression did not tokenize");
+            return;
+        }
+        Ast ast;
+        measure("parser", [&] { ast = Parser(tokens).parse(); });
+        std::string infix;
+        measure("infix printer", [&] { ast.printInfix(infix); });
+    }
+    std::cout << results << std::endl;
+    std::cout << yellow(std::string("characters classified by the ") +
+                        classifyKernel() + " kernel")
+              << std::endl;
+}
+
+static const int BENCH_ALLOC_ROUNDS = 1000;
+// rows evaluated per round
+static const uint64_t BENCH_ALLOC_WORDS = 64;
+
+// /bench --alloc: lexes, parses and evaluates an expression over and over
+// in one arena, counting the heap allocations made after the first round.
+static void benchAllocations(std::string expr) {
+    if (expr.empty()) {
+        printError("usage: /bench --alloc <expr>");
+        return;
+    }
+    if (!countsAllocations()) {
+        printError("allocations are only counted in a `make bench` build");
+        return;
+    }
+    std::transform(expr.begin(), expr.end(), expr.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    auto checked = tokenizeExpression(expr);
+    if (checked.size() == 0) {
+        return;
+    }
+    size_t variables = Interpreter(checked).variableCount();
+    if (variables > TruthTable::MAX_VARIABLES) {
+        printError("too many variables for a truth table");
+        return;
+    }
+    const uint64_t words = std::min<uint64_t>(
+        ((1ull << variables) + 63) / 64, BENCH_ALLOC_WORDS);
+
+    Arena arena;
+    uint64_t ones = 0, allocations = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < BENCH_ALLOC_ROUNDS; round++) {
+        const uint64_t before = heapAllocations();
+        arena.reset();
+        Lexer lexer(expr, &arena);
+        auto tokens = lexer.tokenize();
+        Interpreter interpreter(tokens, &arena);
+        for (uint64_t w = 0; w < words; w++) {
+            ones += __builtin_popcountll(interpreter.evaluateWord(w));
+        }
+        if (round > 0) {
+            allocations += heapAllocations() - before;
+        }
+    }
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    std::stringstream ss;
+    ss << BENCH_ALLOC_ROUNDS << " rounds of lexing, parsing and evaluating "
+       << std::min<uint64_t>(1ull << variables, words * 64) << " rows in "
+       << std::fixed << std::setprecision(3) << elapsed.count() << "s ("
+       << std::setprecision(1) << elapsed.count() * 1e6 / BENCH_ALLOC_ROUNDS
+       << " us each, " << ones / BENCH_ALLOC_ROUNDS << " rows true)";
+    std::cout << ss.str() << std::endl;
+    std::cout << yellow(std::to_string(allocations) +
+                        " heap allocations after the first round, " +
+                        formatRate(arena.bytesUsed()) +
+                        "B of arena per round")
+              << std::endl;
+}
+
+void benchCommand(const std::string& args) {
+    std::string expr(args);
+    trim(expr);
+    if (expr.rfind("--alloc", 0) == 0) {
+        std::string rest = expr.substr(7);
+        trim(rest);
+        benchAllocations(rest);
+        return;
+    }
+    if (expr.rfind("--parse", 0) == 0) {
+        std::string rest = expr.substr(7);
+        trim(rest);
+        benchParse(rest);
+        return;
+    }
+    if (expr.empty()) {
+        printError("usage: /bench <expr>, /bench --parse [<megabytes>] or "
+                   "/bench --alloc <expr>");
+        return;
+    }
+    auto tokens = tokenizeExpression(expr);
+    if (tokens.size() == 0) {
+        return;
+    }
+    auto interpreter = Interpreter(tokens);
+
+    int fd = ::open("/dev/null", O_WRONLY);
+    if (fd < 0) {
+        printError(std::string("cannot open /dev/null: ") +
+                   std::strerror(errno));
+        return;
+    }
+    tabulate::Table results;
+    results.add_row({"output", "size", "time", "bytes", "rows"});
+    results.row(0).format().font_style({tabulate::FontStyle::bold});
+    // prints the table one way into /dev/null, returning the bytes written
+    uint64_t rowCount = 0;
+    auto measure = [&](const std::string& name,
+                       const std::function<size_t()>& print) {
+        auto start = std::chrono::steady_clock::now();
+        size_t bytes = print();
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+        std::stringstream seconds;
+        seconds << std::fixed << std::setprecision(3) << elapsed.count() << "s";
+        double perSecond = 1 / std::max(elapsed.count(), 1e-9);
+        results.add_row({name, formatRate(bytes) + "B", seconds.str(),
+                         formatRate(bytes * perSecond) + "B/s",
+                         formatRate(rowCount * perSecond) + "rows/s"});
+    };
+
+    try {
+        TruthTable table(interpreter);
+        rowCount = table.rowCount();
+        const size_t n = table.variableCount();
+        if (rowCount <= BENCH_TABULATE_ROWS) {
+            measure("tabulate", [&] {
+                std::vector<uint64_t> words(table.wordCount());
+                table.evaluate(0, words.size(), words.data());
+                std::vector<std::vector<bool>> rows;
+                for (uint64_t row = 0; row < rowCount; row++) {
+                    std::vector<bool> cells;
+                    for (size_t i = 0; i < n; i++) {
+                        cells.push_back(TruthTable::variableValue(i, n, row));
+                    }
+                    cells.push_back((words[row / 64] >> (row % 64)) & 1);
+                    rows.push_back(cells);
+                }
+                std::stringstream ss;
+                ss << makeTruthTable(table.getVariables(),
+                                     table.getExpression(), rows)
+                   << "\n";
+                OutputBuffer out(fd);
+                out.append(ss.str());
+                out.flush();
+                return out.bytesWritten();
+            });
+        }
+        TableRenderer renderer(table.getVariables(), table.getExpression(),
+                               false);
+        if (renderer.isValid()) {
+            measure("table templates", [&] {
+                OutputBuffer out(fd);
+                renderer.render(table, out);
+                out.flush();
+                return out.bytesWritten();
+            });
+        }
+        measure("plain rows", [&] {
+            OutputBuffer out(fd);
+            exportTable(table, ExportFormat::BITS, out);
+            out.flush();
+            return out.bytesWritten();
+        });
+    } catch (const std::exception& e) {
+        ::close(fd);
+        printError(e.what());
+        return;
+    }
+    ::close(fd);
+    std::cout << results << std::endl;
+    std::cout << yellow(std::to_string(rowCount) + " rows printed to /dev/null")
+              << std::endl;
+}
+
+void saveCommand(const std::string& args) {
+    std::istringstream ss(args);
+    std::string path, expr;
+    ss >> path;
+    std::getline(ss, expr);
+    trim(expr);
+    if (expr.empty()) {
+        printError("usage: /save <file> <expr>");
+        return;
+    }
+    auto tokens = tokenizeExpression(expr);
+    if (tokens.size() == 0) {
+        return;
+    }
+    auto interpreter = Interpreter(tokens);
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t rows, bytes;
+    try {
+        TruthTable table(interpreter);
+        rows = table.rowCount();
+        bytes = writeTableFile(table, path);
+    } catch (const std::exception& e) {
+        printError(e.what());
+        return;
+    }
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    std::stringstream summary;
+    summary << "saved " << rows << " rows, " << formatRate(bytes) << "B in "
+            << std::fixed << std::setprecision(3) << elapsed.count() << "s";
+    std::cout << purple(path) << ": " << yellow(summary.str()) << std::endl;
+}
+
+template <class File>
+static std::string formatRow(const File& file, uint64_t row) {
+    const auto& variables = file.getVariables();
+    std::string values;
+    for (size_t i = 0; i < variables.size(); i++) {
+        values += " " + variables[i] + "=" +
+                  (file.cell(i, row) ? "true" : "false");
+    }
+    return values;
+}
+
+// Answers a query on a table file or an Arrow file, which share the
+// interface used here.
+template <class File>
+static void runQuery(const File& file, const std::string& path,
+                     const std::string& query) {
+    if (query.empty()) {
+        std::string variables;
+        for (auto& name : file.getVariables()) {
+            variables += name + " ";
+        }
+        std::cout << purple(path) << ": `" << file.getExpression() << "` over "
+                  << variables << std::endl;
+        auto ones = file.ones();
+        std::stringstream stats;
+        stats << file.rowCount() << " rows, " << ones << " true ("
+              << std::fixed << std::setprecision(2)
+              << 100.0 * ones / std::max<uint64_t>(file.rowCount(), 1)
+              << "%), " << formatRate(file.fileSize()) << "B on disk";
+        std::cout << yellow(stats.str()) << std::endl;
+        return;
+    }
+
+    if (std::all_of(query.begin(), query.end(), ::isdigit)) {
+        uint64_t row = std::stoull(query);
+        if (row >= file.rowCount()) {
+            printError("row " + query + " is out of range, the table has " +
+                       std::to_string(file.rowCount()) + " rows");
+            return;
+        }
+        bool value = file.row(row);
+        std::cout << "row " << row << ":" << formatRow(file, row) << " -> "
+                  << (value ? green("true") : red("false")) << std::endl;
+        return;
+    }
+
+    // an expression is tabulated in the file's variable order and compared
+    // with the stored column
+    auto tokens = tokenizeExpression(query);
+    if (tokens.size() == 0) {
+        return;
+    }
+    auto interpreter = Interpreter(tokens);
+    TruthTable table(interpreter, file.getVariables());
+    uint64_t first;
+    auto differing = file.compare(table, first);
+    if (differing == 0) {
+        std::cout << green("`" + table.getExpression() + "` matches `" +
+                           file.getExpression() + "`")
+                  << std::endl;
+    } else {
+        std::cout << red("`" + table.getExpression() + "` differs from `" +
+                         file.getExpression() + "` in " +
+                         std::to_string(differing) + " of " +
+                         std::to_string(file.rowCount()) + " rows")
+                  << std::endl;
+        std::cout << yellow("first at row " + std::to_string(first) + ":" +
+                            formatRow(file, first))
+                  << std::endl;
+    }
+}
+
+// The first bytes of a file, to tell its format.
+static std::string fileMagic(const std::string& path) {
+    char magic[8] = {};
+    std::ifstream in(path, std::ios::binary);
+    in.read(magic, sizeof(magic));
+    return std::string(magic, sizeof(magic));
+}
+
+void queryCommand(const std::string& args) {
+    std::istringstream ss(args);
+    std::string path, query;
+    ss >> path;
+    std::getline(ss, query);
+    trim(query);
+    if (path.empty()) {
+        printError("usage: /query <file> [<row> | <expr>]");
+        return;
+    }
+
+    try {
+        auto magic = fileMagic(path);
+        if (magic.compare(0, 6, "ARROW1") == 0) {
+            runQuery(ArrowFile(path), path, query);
+        } else if (magic == std::string(COMPRESSED_FILE_MAGIC, 8)) {
+            runQuery(CompressedFile(path), path, query);
+        } else {
+            runQuery(TableFile(path), path, query);
+        }
+    } catch (const std::exception& e) {
+        printError(e.what());
+    }
+}
+
+void compressCommand(const std::string& args) {
+    std::istringstream ss(args);
+    std::string path, expr;
+    ss >> path;
+    std::getline(ss, expr);
+    trim(expr);
+    if (expr.empty()) {
+        printError("usage: /compress <file> <expr>");
+        return;
+    }
+    auto tokens = tokenizeExpression(expr);
+    if (tokens.size() == 0) {
+        return;
+    }
+    auto interpreter = Interpreter(tokens);
+
+    try {
+        TruthTable table(interpreter);
+        auto start = std::chrono::steady_clock::now();
+        auto stats = writeCompressedFile(table, path);
+        std::chrono::duration<double> writing =
+            std::chrono::steady_clock::now() - start;
+
+        // read everything back, timing the decoder alone
+        CompressedFile file(path);
+        std::vector<uint64_t> words(COMPRESSED_BLOCK_WORDS);
+        start = std::chrono::steady_clock::now();
+        for (uint64_t b = 0; b < file.blockCount(); b++) {
+            file.decodeBlock(b, words.data());
+        }
+        std::chrono::duration<double> reading =
+            std::chrono::steady_clock::now() - start;
+        uint64_t first;
+        bool verified = file.compare(table, first) == 0;
+
+        // sizes of the packed columns an uncompressed dump would hold
+        double column = table.wordCount() * 8.0;
+        double everything = column * (table.variableCount() + 1);
+        std::stringstream report;
+        report << std::fixed << std::setprecision(1) << table.rowCount()
+               << " rows: " << formatRate(everything)
+               << "B packed with the variable columns, " << formatRate(column)
+               << "B for the result alone, " << formatRate(stats.fileSize)
+               << "B compressed (result column " << column / stats.encodedSize
+               << ":1)";
+        std::cout << purple(path) << ": " << yellow(report.str()) << std::endl;
+
+        std::stringstream details;
+        details << stats.repeats << " repeated, " << stats.references
+                << " dictionary, " << stats.literals
+                << " literal words; compressed at "
+                << formatRate(column / std::max(writing.count(), 1e-9))
+                << "B/s including evaluation, decompressed at "
+                << formatRate(column / std::max(reading.count(), 1e-9))
+                << "B/s";
+        std::cout << yellow(details.str()) << std::endl;
+        if (!verified) {
+            printError("read back column differs from the expression");
+        }
+    } catch (const std::exception& e) {
+        printError(e.what());
+    }
+}
+
+// Parses every line of `path` on all cores and prints a diagnostic for each
+// line that does not parse. Returns false, after printing why, when the file
+// cannot be read.
+static bool ingestAndReport(const std::string& path, IngestStats& stats,
+                            std::vector<FileDiagnostic>& diagnostics) {
+    try {
+        stats = ingestFile(path, 0, diagnostics);
+    } catch (const std::exception& e) {
+        printError(e.what());
+        return false;
+    }
+    for (auto& diagnostic : diagnostics) {
+        std::cout << path << ":" << diagnostic.line << ":" << diagnostic.column
+                  << ": " << red(diagnostic.message) << "\n";
+    }
+    return true;
+}
+
+int checkFile(const std::string& path) {
+    std::vector<FileDiagnostic> diagnostics;
+    IngestStats stats;
+    if (!ingestAndReport(path, stats, diagnostics)) {
+        return 2;
+    }
+
+    const size_t errors = diagnostics.size();
+    std::stringstream ss;
+    ss << "checked " << stats.expressions << " expressions on " << stats.lines
+       << " lines in " << std::fixed << std::setprecision(3) << stats.seconds
+       << "s (" << formatRate(stats.bytes / std::max(stats.seconds, 1e-9))
+       << "B/s), " << errors << (errors == 1 ? " error" : " errors");
+    std::cout << (errors ? red(ss.str()) : green(ss.str())) << std::endl;
+    return errors ? 1 : 0;
+}
+
+int fileCommand(const std::string& path) {
+    std::vector<FileDiagnostic> diagnostics;
+    IngestStats stats;
+    if (!ingestAndReport(path, stats, diagnostics)) {
+        return 2;
+    }
+
+    const double perSecond = 1 / std::max(stats.seconds, 1e-9);
+    tabulate::Table results;
+    results.add_row({"", "count", "per second"});
+    results.row(0).format().font_style({tabulate::FontStyle::bold});
+    auto addRow = [&](const std::string& name, size_t count) {
+        results.add_row({name, std::to_string(count),
+                         formatRate(count * perSecond)});
+    };
+    addRow("bytes", stats.bytes);
+    addRow("lines", stats.lines);
+    addRow("expressions", stats.expressions);
+    addRow("tokens", stats.tokens);
+    addRow("syntax tree nodes", stats.nodes);
+    std::cout << results << std::endl;
+
+    std::stringstream ss;
+    ss << "parsed " << path << " in " << std::fixed << std::setprecision(3)
+       << stats.seconds << "s on " << stats.threads
+       << (stats.threads == 1 ? " thread, " : " threads, ") << stats.variables
+       << (stats.variables == 1 ? " variable, " : " distinct variables, ")
+       << diagnostics.size()
+       << (diagnostics.size() == 1 ? " error" : " errors");
+    std::cout << (diagnostics.empty() ? green(ss.str()) : red(ss.str()))
+              << std::endl;
+    return diagnostics.empty() ? 0 : 1;
+}
+
+// the stress inputs, a long expression of over a million tokens and one
+// nested over a hundred thousand deep
+static const size_t STRESS_LONG_BYTES = 4 << 20;
+static const size_t STRESS_DEEP_BYTES = 1 << 20;
+// few enough for the expressions to be evaluated in full
+static const size_t STRESS_VARIABLES = 10;
+// too many for a truth table, as in most real inputs of this size
+static const size_t STRESS_WIDE_VARIABLES = 1000;
+// the most either full size input may take, in seconds
+static const double STRESS_SECONDS = 10;
+// doubling an input may multiply its time by at most this much
+static const double STRESS_GROWTH = 3;
+static const int STRESS_RUNS = 5;
+
+struct StressInput {
+    const char* name;
+    size_t bytes;
+    bool deep;
+    size_t variables;
+};
+static const StressInput STRESS_INPUTS[] = {
+    {"long", STRESS_LONG_BYTES, false, STRESS_VARIABLES},
+    {"deep", STRESS_DEEP_BYTES, true, STRESS_VARIABLES},
+    {"wide", STRESS_LONG_BYTES, false, STRESS_WIDE_VARIABLES},
+};
+
+// Lexes, parses, evaluates and prints the truth table of an expression to
+// `fd`, returning the time taken (the best of STRESS_RUNS runs). An
+// expression with too many variables for a table is only added to an
+// equivalence checker, as it is at the prompt, where evaluate() would print
+// nothing but the reason it has no table.
+static double stressRun(const std::string& expr, int fd, size_t& tokenCount,
+                        size_t& depth) {
+    double best = 1e9;
+    for (int run = 0; run < STRESS_RUNS; run++) {
+        auto start = std::chrono::steady_clock::now();
+        Arena arena;
+        Lexer lexer(expr, &arena);
+        auto tokens = lexer.tokenize();
+        if (tokens.size() == 0) {
+            throw std::runtime_error("the generated expression is invalid");
+        }
+        Interpreter interpreter(tokens, &arena);
+        if (interpreter.variableCount() > TruthTable::MAX_VARIABLES) {
+            EquivalenceChecker checker;
+            checker.add(interpreter);
+        } else {
+            TruthTable table(interpreter);
+            OutputBuffer out(fd);
+            exportTable(table, ExportFormat::BITS, out);
+            out.flush();
+        }
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+
+        tokenCount = tokens.size();
+        depth = 0;
+        size_t open = 0;
+        for (auto& token : tokens) {
+            if (token.getTokenType() == TokenType::LPAREN) {
+                depth = std::max(depth, ++open);
+            } else if (token.getTokenType() == TokenType::RPAREN) {
+                open--;
+            }
+        }
+    }
+    return best;
+}
+
+int stressTest() {
+    int fd = ::open("/dev/null", O_WRONLY);
+    if (fd < 0) {
+        printError(std::string("cannot open /dev/null: ") +
+                   std::strerror(errno));
+        return 1;
+    }
+    tabulate::Table results;
+    results.add_row({"input", "tokens", "depth", "time", "half size",
+                     "growth"});
+    results.row(0).format().font_style({tabulate::FontStyle::bold});
+    bool passed = true;
+    try {
+        for (auto& input : STRESS_INPUTS) {
+            size_t tokens, depth, halfTokens, halfDepth;
+            double half = stressRun(generateExpression(input.bytes / 2,
+                                                       input.deep,
+                                                       input.variables),
+                                    fd, halfTokens, halfDepth);
+            double full = stressRun(
+                generateExpression(input.bytes, input.deep, input.variables),
+                fd, tokens, depth);
+            // allow for timer noise on the small inputs
+            double growth = full / std::max(half, 1e-3);
+            bool ok = full <= STRESS_SECONDS && growth <= STRESS_GROWTH;
+            passed = passed && ok;
+
+            std::stringstream time, halfTime, ratio;
+            time << std::fixed << std::setprecision(3) << full << "s";
+            halfTime << std::fixed << std::setprecision(3) << half << "s";
+            ratio << std::fixed << std::setprecision(2) << growth << "x"
+                  << (ok ? "" : " FAIL");
+            results.add_row({input.name, std::to_string(tokens),
+                             std::to_string(depth), time.str(),
+                             halfTime.str(), ratio.str()});
+        }
+    } catch (const std::exception& e) {
+        ::close(fd);
+        printError(e.what());
+        return 1;
+    }
+    ::close(fd);
+    std::cout << results << std::endl;
+
+    std::stringstream ss;
+    ss << "lexing, parsing, evaluating and printing the full size inputs "
+       << "must take at most " << STRESS_SECONDS << "s, and at most "
+       << STRESS_GROWTH << " times as long as the half size ones";
+    std::cout << (passed ? green(ss.str()) : red(ss.str())) << std::endl;
+    return passed ? 0 : 1;
+}
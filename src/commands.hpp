@@ -0,0 +1,87 @@
+#ifndef COMMANDS_H
+#define COMMANDS_H
+
+#include <string>
+
+// REPL commands that take arguments. Each command prints its own results
+// and reports problems to the console instead of throwing.
+
+// /aiger <file> [patterns]
+// Loads a combinational AIGER circuit and simulates it with random patterns.
+void aigerCommand(const std::string& args);
+
+// /fraig <file> <file>  or  /fraig <expr>, <expr>[, <expr>...]
+// Checks two circuits (outputs and inputs matched by position) or several
+// expressions (variables matched by name) for equivalence by SAT sweeping.
+void fraigCommand(const std::string& args);
+
+// /sat [-j <solvers>] <expr>
+// Decides satisfiability with a portfolio of solvers running in parallel,
+// one per hardware thread unless told otherwise.
+void satCommand(const std::string& args);
+
+// /export <csv|md|jsonl|arrow|bits> <file> <expr>
+// Streams the truth table of an expression into a file (or stdout for -)
+// without building it in memory.
+void exportCommand(const std::string& args);
+
+// /page <expr>
+// Browses the truth table of an expression in a full screen pager that
+// evaluates only the rows on screen.
+void pageCommand(const std::string& args);
+
+// /summary [-n <rows>] <expr>
+// Prints the first and the last rows of a truth table (5 of each unless
+// told otherwise) with the number of true rows, the first and the last of
+// them, counted in one pass over the packed result column.
+void summaryCommand(const std::string& args);
+
+// /bench <expr>
+// Times the ways pensieve can print a truth table: tabulate (small tables
+// only), the table templates used for large tables on a terminal and the
+// plain rows written to pipes and files.
+// /bench --parse [<megabytes>] times the lexer, the parser and the infix
+// printer on generated long and deeply nested expressions of that size
+// instead, /bench --alloc <expr> counts the heap allocations made while
+// lexing, parsing and evaluating an expression again and again in an arena.
+void benchCommand(const std::string& args);
+
+// /save <file> <expr>
+// Writes the packed truth table of an expression to a binary table file.
+void saveCommand(const std::string& args);
+
+// /compress <file> <expr>
+// Writes a compressed table file and reports its size against the packed
+// columns, along with compression and decompression speed.
+void compressCommand(const std::string& args);
+
+// /query <file> [<row> | <expr>]
+// Memory-maps a table file (plain, compressed or an Arrow file of boolean
+// columns) and shows its summary, the value of one row, or the rows in
+// which an expression over the same variables differs from it.
+void queryCommand(const std::string& args);
+
+// pensieve --check <file>
+// Lexes and parses every expression of a file, one comma separated list per
+// line as typed at the prompt (blank lines and commands are skipped), on
+// all the cores and without evaluating any of them (see ingest.hpp). Every
+// error is reported as file:line:column, and the exit status is 1 when
+// there were any.
+int checkFile(const std::string& path);
+
+// pensieve --file <file>
+// Ingests a file of expressions the same way and reports its errors along
+// with how much of each it parsed and how fast.
+int fileCommand(const std::string& path);
+
+// pensieve --stress
+// Lexes, parses, evaluates and prints to /dev/null a generated expression of
+// over a million tokens and one nested over a hundred thousand deep, each
+// at full and at half size. A third one of over a million tokens has a
+// thousand variables, too many for a table, and goes the way it would at
+// the prompt, through the interpreter into the equivalence checker. Fails
+// (returns 1) unless every stage grows linearly and the full size inputs
+// finish within a time bound.
+int stressTest();
+
+#endif // COMMANDS_H
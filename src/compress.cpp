@@ -0,0 +1,357 @@
+#include "compress.hpp"
+#include "outbuf.hpp"
+#include "tablefile.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const uint8_t LITERALS = 0x00;
+static const uint8_t REFERENCES = 0x40;
+static const uint8_t REPEAT = 0x80;
+static const size_t GROUP_LIMIT = 64;
+
+static inline uint8_t dictionarySlot(uint64_t word) {
+    return (word * 0x9e3779b97f4a7c15ull) >> 56;
+}
+
+// Encodes one block at a time into the output buffer, keeping literal and
+// reference groups open until the kind of word changes.
+class BlockEncoder {
+private:
+    OutputBuffer& out;
+    CompressionStats& stats;
+    uint64_t dictionary[256];
+    uint64_t previous;
+    uint64_t repeats;
+    uint64_t literals[GROUP_LIMIT];
+    size_t literalCount;
+    uint8_t references[GROUP_LIMIT];
+    size_t referenceCount;
+
+    void flushRepeats() {
+        if (repeats == 0) {
+            return;
+        }
+        uint8_t bytes[11];
+        size_t n = 0;
+        bytes[n++] = REPEAT;
+        for (auto count = repeats; ; count >>= 7) {
+            bytes[n++] = (count & 0x7f) | (count >> 7 ? 0x80 : 0);
+            if (count >> 7 == 0) {
+                break;
+            }
+        }
+        out.append(reinterpret_cast<const char*>(bytes), n);
+        stats.repeats += repeats;
+        repeats = 0;
+    }
+    void flushLiterals() {
+        if (literalCount == 0) {
+            return;
+        }
+        out.put(LITERALS | (literalCount - 1));
+        out.append(reinterpret_cast<const char*>(literals), literalCount * 8);
+        stats.literals += literalCount;
+        literalCount = 0;
+    }
+    void flushReferences() {
+        if (referenceCount == 0) {
+            return;
+        }
+        out.put(REFERENCES | (referenceCount - 1));
+        out.append(reinterpret_cast<const char*>(references), referenceCount);
+        stats.references += referenceCount;
+        referenceCount = 0;
+    }
+
+public:
+    BlockEncoder(OutputBuffer& out, CompressionStats& stats)
+        : out(out), stats(stats) {
+        reset();
+    }
+
+    void reset() {
+        std::memset(dictionary, 0, sizeof(dictionary));
+        previous = 0;
+        repeats = 0;
+        literalCount = 0;
+        referenceCount = 0;
+    }
+
+    void add(uint64_t word) {
+        if (word == previous) {
+            flushLiterals();
+            flushReferences();
+            repeats++;
+            return;
+        }
+        flushRepeats();
+        previous = word;
+        auto slot = dictionarySlot(word);
+        if (dictionary[slot] == word) {
+            flushLiterals();
+            references[referenceCount++] = slot;
+            if (referenceCount == GROUP_LIMIT) {
+                flushReferences();
+            }
+        } else {
+            flushReferences();
+            dictionary[slot] = word;
+            literals[literalCount++] = word;
+            if (literalCount == GROUP_LIMIT) {
+                flushLiterals();
+            }
+        }
+    }
+
+    void finish() {
+        flushRepeats();
+        flushLiterals();
+        flushReferences();
+    }
+};
+
+static std::runtime_error fileError(const std::string& what,
+                                    const std::string& path) {
+    return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+CompressionStats writeCompressedFile(TruthTable& table,
+                                     const std::string& path) {
+    CompressedHeader header;
+    std::memcpy(header.magic, COMPRESSED_FILE_MAGIC, sizeof(header.magic));
+    header.byteOrder = TABLE_FILE_BYTE_ORDER;
+    header.variableCount = table.variableCount();
+    header.rowCount = table.rowCount();
+    header.ones = 0;
+    header.indexOffset = 0;
+
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw fileError("cannot open", path);
+    }
+    CompressionStats stats;
+    try {
+        OutputBuffer out(fd);
+        // the count of true rows and the index position are only known at
+        // the end, the header is rewritten then
+        out.append(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.append(encodeTableNames(table));
+
+        BlockEncoder encoder(out, stats);
+        std::vector<uint64_t> index;
+        std::vector<uint64_t> words(TruthTable::BATCH_ROWS / 64);
+        const uint64_t total = table.wordCount();
+        const uint64_t blocksStart = out.bytesWritten();
+        for (uint64_t first = 0; first < total; first += words.size()) {
+            size_t count = std::min<uint64_t>(words.size(), total - first);
+            table.evaluate(first, count, words.data());
+            for (size_t w = 0; w < count; w++) {
+                if ((first + w) % COMPRESSED_BLOCK_WORDS == 0) {
+                    encoder.finish();
+                    encoder.reset();
+                    index.push_back(out.bytesWritten());
+                }
+                header.ones += __builtin_popcountll(words[w]);
+                encoder.add(words[w]);
+            }
+        }
+        encoder.finish();
+        stats.encodedSize = out.bytesWritten() - blocksStart;
+
+        header.indexOffset = out.bytesWritten();
+        out.append(reinterpret_cast<const char*>(index.data()),
+                   index.size() * sizeof(uint64_t));
+        out.flush();
+        stats.fileSize = out.bytesWritten();
+        if (::pwrite(fd, &header, sizeof(header), 0) != sizeof(header)) {
+            throw fileError("cannot write", path);
+        }
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    if (::close(fd) != 0) {
+        throw fileError("cannot write", path);
+    }
+    return stats;
+}
+
+CompressedFile::CompressedFile(const std::string& path) {
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw fileError("cannot open", path);
+    }
+    struct stat st;
+    void* mapped = MAP_FAILED;
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+        size = st.st_size;
+        mapped = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    if (mapped == MAP_FAILED) {
+        auto error = fileError("cannot map", path);
+        ::close(fd);
+        throw error;
+    }
+    base = static_cast<const uint8_t*>(mapped);
+    // the destructor does not run for a throwing constructor
+    try {
+        parse();
+    } catch (const std::runtime_error& e) {
+        ::munmap(const_cast<uint8_t*>(base), size);
+        ::close(fd);
+        throw std::runtime_error(path + ": " + e.what());
+    }
+}
+
+CompressedFile::~CompressedFile() {
+    ::munmap(const_cast<uint8_t*>(base), size);
+    ::close(fd);
+}
+
+void CompressedFile::parse() {
+    if (size < sizeof(header)) {
+        throw std::runtime_error("not a compressed truth table file");
+    }
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, COMPRESSED_FILE_MAGIC,
+                    sizeof(header.magic))) {
+        throw std::runtime_error("not a compressed truth table file");
+    }
+    if (header.byteOrder != TABLE_FILE_BYTE_ORDER) {
+        throw std::runtime_error("written with a different byte order");
+    }
+    if (header.variableCount > TruthTable::MAX_VARIABLES ||
+        header.rowCount != 1ull << header.variableCount ||
+        header.indexOffset < sizeof(header) || header.indexOffset > size ||
+        (size - header.indexOffset) / sizeof(uint64_t) < blockCount()) {
+        throw std::runtime_error("truncated or corrupt header");
+    }
+    if (!decodeTableNames(reinterpret_cast<const char*>(base) + sizeof(header),
+                          header.indexOffset - sizeof(header),
+                          header.variableCount, variables, expression)) {
+        throw std::runtime_error("truncated names");
+    }
+    index = base + header.indexOffset;
+    for (uint64_t b = 0; b < blockCount(); b++) {
+        auto offset = blockOffset(b);
+        if (offset < sizeof(header) || offset > header.indexOffset) {
+            throw std::runtime_error("corrupt block index");
+        }
+    }
+}
+
+// the index is not necessarily aligned, so entries are copied out
+uint64_t CompressedFile::blockOffset(uint64_t block) const {
+    uint64_t offset;
+    std::memcpy(&offset, index + block * sizeof(offset), sizeof(offset));
+    return offset;
+}
+
+void CompressedFile::decodeBlock(uint64_t block, uint64_t* out) const {
+    uint64_t start = blockOffset(block);
+    uint64_t end = block + 1 < blockCount() ? blockOffset(block + 1)
+                                            : header.indexOffset;
+    const uint8_t* in = base + start;
+    const uint8_t* stop = base + std::max(start, end);
+    const size_t count = blockWords(block);
+
+    uint64_t dictionary[256] = {};
+    uint64_t previous = 0;
+    size_t filled = 0;
+    auto corrupt = [block]() {
+        return std::runtime_error("block " + std::to_string(block) +
+                                  " is corrupt");
+    };
+    while (filled < count) {
+        if (in == stop) {
+            throw corrupt();
+        }
+        uint8_t control = *in++;
+        if (control == REPEAT) {
+            uint64_t repeats = 0;
+            for (int shift = 0; ; shift += 7) {
+                if (in == stop || shift > 63) {
+                    throw corrupt();
+                }
+                uint8_t byte = *in++;
+                repeats |= (uint64_t)(byte & 0x7f) << shift;
+                if (!(byte & 0x80)) {
+                    break;
+                }
+            }
+            if (repeats > count - filled) {
+                throw corrupt();
+            }
+            std::fill(out + filled, out + filled + repeats, previous);
+            filled += repeats;
+            continue;
+        }
+        size_t group = (control & 0x3f) + 1;
+        if (control > 0x7f || group > count - filled) {
+            throw corrupt();
+        }
+        if (control < REFERENCES) {
+            if ((size_t)(stop - in) < group * 8) {
+                throw corrupt();
+            }
+            std::memcpy(out + filled, in, group * 8);
+            in += group * 8;
+            for (size_t i = 0; i < group; i++) {
+                auto word = out[filled + i];
+                dictionary[dictionarySlot(word)] = word;
+            }
+        } else {
+            if ((size_t)(stop - in) < group) {
+                throw corrupt();
+            }
+            for (size_t i = 0; i < group; i++) {
+                out[filled + i] = dictionary[*in++];
+            }
+        }
+        filled += group;
+        previous = out[filled - 1];
+    }
+}
+
+bool CompressedFile::row(uint64_t r) const {
+    uint64_t block = (r >> 6) / COMPRESSED_BLOCK_WORDS;
+    if (block != cachedBlock) {
+        cache.resize(COMPRESSED_BLOCK_WORDS);
+        decodeBlock(block, cache.data());
+        cachedBlock = block;
+    }
+    return (cache[(r >> 6) % COMPRESSED_BLOCK_WORDS] >> (r & 63)) & 1;
+}
+
+uint64_t CompressedFile::compare(TruthTable& table,
+                                 uint64_t& firstDifference) const {
+    if (table.getVariables() != variables) {
+        throw std::runtime_error("tables are over different variables");
+    }
+    uint64_t differing = 0;
+    firstDifference = header.rowCount;
+    std::vector<uint64_t> stored(COMPRESSED_BLOCK_WORDS);
+    std::vector<uint64_t> fresh(COMPRESSED_BLOCK_WORDS);
+    for (uint64_t b = 0; b < blockCount(); b++) {
+        const uint64_t first = b * COMPRESSED_BLOCK_WORDS;
+        const size_t count = blockWords(b);
+        decodeBlock(b, stored.data());
+        table.evaluate(first, count, fresh.data());
+        for (size_t w = 0; w < count; w++) {
+            uint64_t diff = fresh[w] ^ stored[w];
+            if (diff == 0) {
+                continue;
+            }
+            if (differing == 0) {
+                firstDifference = 64 * (first + w) + __builtin_ctzll(diff);
+            }
+            differing += __builtin_popcountll(diff);
+        }
+    }
+    return differing;
+}
@@ -0,0 +1,110 @@
+#ifndef COMPRESS_H
+#define COMPRESS_H
+
+#include "truthtable.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Compressed truth table file. Variable columns are periodic and follow from
+// the row index, so only their names are stored; the result column is cut
+// into blocks of COMPRESSED_BLOCK_WORDS packed words, each encoded on its
+// own so that a single row can be read without decoding what precedes it.
+//
+//   header      CompressedHeader
+//   names       as in table files, see encodeTableNames()
+//   blocks      encoded result words
+//   index       a uint64 file offset per block
+//
+// Within a block, every word is either a repeat of the previous word, a
+// reference to one of 256 recently seen words (a dictionary indexed by a
+// hash of the word, updated the same way by encoder and decoder) or a
+// literal. They are grouped behind control bytes:
+//
+//   0x00 - 0x3f   1 to 64 literal words follow, 8 bytes each
+//   0x40 - 0x7f   1 to 64 dictionary indices follow, 1 byte each
+//   0x80          a varint count follows, the previous word repeats that
+//                 many times (the word before a block's first is zero)
+const char COMPRESSED_FILE_MAGIC[8] = {'P', 'N', 'S', 'V', 'T', 'Z', '\0',
+                                       '\1'};
+const uint64_t COMPRESSED_BLOCK_WORDS = 1 << 16;
+
+struct CompressedHeader {
+    char magic[8];
+    uint32_t byteOrder;
+    uint32_t variableCount;
+    uint64_t rowCount;
+    uint64_t ones;
+    uint64_t indexOffset;
+};
+
+struct CompressionStats {
+    uint64_t fileSize = 0;
+    // bytes of the encoded blocks alone
+    uint64_t encodedSize = 0;
+    uint64_t literals = 0;
+    uint64_t references = 0;
+    uint64_t repeats = 0;
+};
+
+// Writes the table to `path`, compressing the result column as it is
+// evaluated. Throws std::runtime_error when the file cannot be written.
+CompressionStats writeCompressedFile(TruthTable& table,
+                                     const std::string& path);
+
+// Read-only view of a compressed file through mmap(2). Blocks are decoded
+// on demand, the one holding the last row looked up is kept.
+class CompressedFile {
+private:
+    int fd = -1;
+    const uint8_t* base = nullptr;
+    size_t size = 0;
+    CompressedHeader header;
+    const uint8_t* index = nullptr;
+    std::vector<std::string> variables;
+    std::string expression;
+    mutable std::vector<uint64_t> cache;
+    mutable uint64_t cachedBlock = UINT64_MAX;
+
+    void parse();
+    uint64_t blockOffset(uint64_t block) const;
+
+public:
+    // Throws std::runtime_error when the file cannot be mapped or is not a
+    // valid compressed file.
+    CompressedFile(const std::string& path);
+    ~CompressedFile();
+    CompressedFile(const CompressedFile&) = delete;
+    CompressedFile& operator=(const CompressedFile&) = delete;
+
+    const std::vector<std::string>& getVariables() const { return variables; }
+    const std::string& getExpression() const { return expression; }
+    uint64_t rowCount() const { return header.rowCount; }
+    uint64_t wordCount() const { return (header.rowCount + 63) / 64; }
+    uint64_t ones() const { return header.ones; }
+    size_t fileSize() const { return size; }
+    uint64_t blockCount() const {
+        return (wordCount() + COMPRESSED_BLOCK_WORDS - 1) /
+               COMPRESSED_BLOCK_WORDS;
+    }
+    uint64_t blockWords(uint64_t block) const {
+        return std::min(COMPRESSED_BLOCK_WORDS,
+                        wordCount() - block * COMPRESSED_BLOCK_WORDS);
+    }
+
+    // Decodes all words of a block into `out`. Throws std::runtime_error
+    // when the block is corrupt.
+    void decodeBlock(uint64_t block, uint64_t* out) const;
+
+    bool row(uint64_t r) const;
+    bool cell(size_t column, uint64_t r) const {
+        return column < variables.size()
+                   ? TruthTable::variableValue(column, variables.size(), r)
+                   : row(r);
+    }
+
+    uint64_t compare(TruthTable& table, uint64_t& firstDifference) const;
+};
+
+#endif // COMPRESS_H
@@ -1,4 +1,5 @@
 #include "constants.hpp"
+#include <unistd.h>
 
 const std::string COLOR_RED = "\033[31m";
 const std::string COLOR_GREEN = "\033[32m";
@@ -8,8 +9,15 @@ const std::string COLOR_PURPLE = "\033[35m";
 const std::string COLOR_CYAN = "\033[36m";
 const std::string COLOR_RESET = "\033[0m";
 
-std::string purple(std::string s) { return COLOR_PURPLE + s + COLOR_RESET; }
-std::string cyan(std::string s) { return COLOR_CYAN + s + COLOR_RESET; }
-std::string green(std::string s) { return COLOR_GREEN + s + COLOR_RESET; }
-std::string red(std::string s) { return COLOR_RED + s + COLOR_RESET; }
-std::string yellow(std::string s) { return COLOR_YELLOW + s + COLOR_RESET; }
+// colour codes are only worth writing to a terminal
+static const bool colourOutput = isatty(STDOUT_FILENO);
+
+static std::string paint(const std::string& colour, std::string s) {
+    return colourOutput ? colour + s + COLOR_RESET : s;
+}
+
+std::string purple(std::string s) { return paint(COLOR_PURPLE, s); }
+std::string cyan(std::string s) { return paint(COLOR_CYAN, s); }
+std::string green(std::string s) { return paint(COLOR_GREEN, s); }
+std::string red(std::string s) { return paint(COLOR_RED, s); }
+std::string yellow(std::string s) { return paint(COLOR_YELLOW, s); }
@@ -12,7 +12,8 @@ extern const std::string COLOR_PURPLE;
 extern const std::string COLOR_CYAN;
 extern const std::string COLOR_RESET;
 
-// Color utility functions
+// Color utility functions, which leave the text alone when stdout is not a
+// terminal
 std::string purple(std::string s);
 std::string cyan(std::string s);
 std::string green(std::string s);
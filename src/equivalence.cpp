@@ -0,0 +1,26 @@
+#include "equivalence.hpp"
+
+EquivalenceChecker::EquivalenceChecker() : encoder(aig, solver) {}
+
+AigLit EquivalenceChecker::add(Interpreter& interpreter) {
+    return interpreter.buildAIG(aig);
+}
+
+bool EquivalenceChecker::equivalent(
+    AigLit a, AigLit b,
+    std::vector<std::pair<std::string, bool>>& counterexample) {
+    if (a == b) {
+        return true;
+    }
+    if (encoder.checkEquivalence(a, b) != SatResult::SATISFIABLE) {
+        return true;
+    }
+
+    counterexample.clear();
+    for (auto i : aig.support({a, b})) {
+        auto var = encoder.nodeVar(aig.inputNode(i));
+        counterexample.emplace_back(aig.inputName(i),
+                                    solver.modelValue(satMakeLit(var)));
+    }
+    return false;
+}
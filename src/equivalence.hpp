@@ -0,0 +1,34 @@
+#ifndef EQUIVALENCE_H
+#define EQUIVALENCE_H
+
+#include "aig.hpp"
+#include "cnf.hpp"
+#include "interpreter.hpp"
+#include "solver.hpp"
+#include <string>
+#include <utility>
+#include <vector>
+
+// Checks expressions for logical equivalence on one shared AIG and one
+// incremental solver. Variables are matched by name, common subexpressions
+// are merged by structural hashing, and every check keeps the clauses it
+// encoded and learnt, so checking many variants of one base formula only
+// pays for what differs between them.
+class EquivalenceChecker {
+private:
+    AIG aig;
+    Solver solver;
+    CnfEncoder encoder;
+
+public:
+    EquivalenceChecker();
+
+    AigLit add(Interpreter& interpreter);
+    // Whether two added expressions are equivalent. When they are not,
+    // `counterexample` receives variable values telling them apart.
+    bool equivalent(AigLit a, AigLit b,
+                    std::vector<std::pair<std::string, bool>>& counterexample);
+    const SolverStats& getStats() const { return solver.getStats(); }
+};
+
+#endif // EQUIVALENCE_H
@@ -0,0 +1,76 @@
+#include "exchange.hpp"
+
+ClauseExchange::ClauseExchange(size_t capacity)
+    : capacity(capacity), slots(new Slot[capacity]) {}
+
+// A slot holding ticket t has sequence 2t + 1 while it is being written and
+// 2t + 2 once it is published.
+//
+// Tickets t and t + capacity share a slot, so a producer that stalled for a
+// whole lap of the ring would otherwise write it along with the next one.
+// The slot is claimed with a compare-and-swap from a published (or never
+// used) state of an earlier ticket; when another producer is writing it or
+// a later ticket already took it, the clause is dropped instead.
+void ClauseExchange::publish(uint32_t producer,
+                             const std::vector<SatLit>& lits) {
+    if (lits.empty() || lits.size() > MAX_CLAUSE_SIZE) {
+        return;
+    }
+    auto ticket = writeTicket.fetch_add(1, std::memory_order_relaxed);
+    auto& slot = slots[ticket % capacity];
+
+    auto current = slot.sequence.load(std::memory_order_relaxed);
+    if (current % 2 == 1 || current >= 2 * ticket + 1 ||
+        !slot.sequence.compare_exchange_strong(current, 2 * ticket + 1,
+                                               std::memory_order_relaxed)) {
+        return;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.producer.store(producer, std::memory_order_relaxed);
+    slot.size.store(lits.size(), std::memory_order_relaxed);
+    for (size_t i = 0; i < lits.size(); i++) {
+        slot.lits[i].store(lits[i], std::memory_order_relaxed);
+    }
+    slot.sequence.store(2 * ticket + 2, std::memory_order_release);
+}
+
+size_t ClauseExchange::collect(uint32_t consumer, uint64_t& cursor,
+                               std::vector<std::vector<SatLit>>& out) {
+    auto end = writeTicket.load(std::memory_order_acquire);
+    if (end > capacity && cursor < end - capacity) {
+        // these slots were already reused
+        cursor = end - capacity;
+    }
+
+    size_t read = 0;
+    std::vector<SatLit> lits;
+    for (; cursor < end; cursor++) {
+        auto ticket = cursor;
+        auto& slot = slots[ticket % capacity];
+        auto before = slot.sequence.load(std::memory_order_acquire);
+        if (before < 2 * ticket + 2) {
+            // still being written, try again on the next visit (a ticket
+            // whose producer dropped its clause is passed once the ring laps
+            // it)
+            break;
+        }
+        if (before > 2 * ticket + 2) {
+            continue;
+        }
+
+        auto producer = slot.producer.load(std::memory_order_relaxed);
+        size_t size = slot.size.load(std::memory_order_relaxed);
+        lits.resize(std::min(size, MAX_CLAUSE_SIZE));
+        for (size_t i = 0; i < lits.size(); i++) {
+            lits[i] = slot.lits[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != before ||
+            producer == consumer) {
+            continue;
+        }
+        out.push_back(lits);
+        read++;
+    }
+    return read;
+}
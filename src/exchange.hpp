@@ -0,0 +1,51 @@
+#ifndef EXCHANGE_H
+#define EXCHANGE_H
+
+#include "solver.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Lock-free buffer through which solvers running in parallel on the same
+// formula share short learnt clauses.
+//
+// The buffer is a ring of fixed size slots, each guarded by its own sequence
+// number in the style of a seqlock: a producer claims a ticket with one
+// fetch_add, claims the slot with a compare-and-swap on its sequence, fills
+// it and publishes it. A producer that finds the slot still being written,
+// or already taken by a later ticket, drops its clause. Every consumer
+// keeps its own read cursor and drops slots that were overwritten while it
+// was reading or that it fell too far behind on. Nobody ever waits on
+// anybody else.
+class ClauseExchange {
+public:
+    static constexpr size_t MAX_CLAUSE_SIZE = 8;
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};
+        std::atomic<uint32_t> producer{0};
+        std::atomic<uint32_t> size{0};
+        std::atomic<SatLit> lits[MAX_CLAUSE_SIZE];
+    };
+
+    size_t capacity;
+    std::unique_ptr<Slot[]> slots;
+    std::atomic<uint64_t> writeTicket{0};
+
+public:
+    ClauseExchange(size_t capacity = 1 << 14);
+
+    // Publishes a clause of at most MAX_CLAUSE_SIZE literals.
+    void publish(uint32_t producer, const std::vector<SatLit>& lits);
+    // Appends to `out` the clauses published by other producers since the
+    // consumer's last visit, returning how many were read. `cursor` is the
+    // consumer's position in the ring and starts at zero.
+    size_t collect(uint32_t consumer, uint64_t& cursor,
+                   std::vector<std::vector<SatLit>>& out);
+    uint64_t published() const { return writeTicket.load(); }
+};
+
+#endif // EXCHANGE_H
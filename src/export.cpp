@@ -0,0 +1,170 @@
+#include "export.hpp"
+#include "arrow.hpp"
+#include "rowformat.hpp"
+#include "rowwriter.hpp"
+#include <algorithm>
+#include <atomic>
+
+bool parseExportFormat(const std::string& name, ExportFormat& format) {
+    if (name == "csv") {
+        format = ExportFormat::CSV;
+    } else if (name == "md" || name == "markdown") {
+        format = ExportFormat::MARKDOWN;
+    } else if (name == "jsonl") {
+        format = ExportFormat::JSONL;
+    } else if (name == "arrow") {
+        format = ExportFormat::ARROW;
+    } else if (name == "bits") {
+        format = ExportFormat::BITS;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static std::string csvField(const std::string& s) {
+    if (s.find_first_of(",\"\n") == std::string::npos) {
+        return s;
+    }
+    std::string quoted = "\"";
+    for (char c : s) {
+        quoted += c == '"' ? "\"\"" : std::string(1, c);
+    }
+    return quoted + "\"";
+}
+
+static std::string markdownCell(const std::string& s) {
+    std::string escaped;
+    for (char c : s) {
+        if (c == '|' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+static std::string jsonString(const std::string& s) {
+    std::string escaped = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped + "\"";
+}
+
+// The text around each cell of a row. Every format writes a row as
+// prefix[0] value prefix[1] value ... prefix[n] value end.
+struct RowLayout {
+    std::string header;
+    std::vector<std::string> prefix;
+    std::string end;
+    std::string trueText = "true";
+    std::string falseText = "false";
+};
+
+// The header of the result column: the expression, unless it is a bare
+// variable and would repeat that variable's key. Names cannot hold spaces, so
+// the suffixed one is unique.
+static std::string resultColumn(const TruthTable& table) {
+    auto& variables = table.getVariables();
+    const std::string& expression = table.getExpression();
+    if (std::find(variables.begin(), variables.end(), expression) !=
+        variables.end()) {
+        return expression + " (result)";
+    }
+    return expression;
+}
+
+static RowLayout makeLayout(const TruthTable& table, ExportFormat format) {
+    std::vector<std::string> columns(table.getVariables());
+    columns.push_back(resultColumn(table));
+
+    RowLayout layout;
+    for (size_t i = 0; i < columns.size(); i++) {
+        switch (format) {
+        case ExportFormat::CSV:
+            layout.header += (i ? "," : "") + csvField(columns[i]);
+            layout.prefix.push_back(i ? "," : "");
+            break;
+        case ExportFormat::MARKDOWN:
+            layout.header += "| " + markdownCell(columns[i]) + " ";
+            layout.prefix.push_back(i ? " | " : "| ");
+            break;
+        case ExportFormat::JSONL:
+            layout.prefix.push_back((i ? "," : "{") + jsonString(columns[i]) +
+                                    ":");
+            break;
+        case ExportFormat::ARROW:
+            // binary, see writeArrow()
+            break;
+        case ExportFormat::BITS:
+            layout.header += (i + 1 < columns.size() ? "" : "| ") +
+                             columns[i] + (i + 1 < columns.size() ? " " : "");
+            layout.prefix.push_back(i + 1 < columns.size() ? "" : " ");
+            break;
+        }
+    }
+    switch (format) {
+    case ExportFormat::CSV:
+        layout.header += "\n";
+        layout.end = "\n";
+        break;
+    case ExportFormat::MARKDOWN:
+        layout.header += "|\n";
+        for (size_t i = 0; i < columns.size(); i++) {
+            layout.header += "| --- ";
+        }
+        layout.header += "|\n";
+        layout.end = " |\n";
+        break;
+    case ExportFormat::JSONL:
+        layout.end = "}\n";
+        break;
+    case ExportFormat::ARROW:
+        break;
+    case ExportFormat::BITS:
+        layout.header += "\n";
+        layout.end = "\n";
+        layout.trueText = "1";
+        layout.falseText = "0";
+        break;
+    }
+    return layout;
+}
+
+void exportTable(TruthTable& table, ExportFormat format, OutputBuffer& out) {
+    if (format == ExportFormat::ARROW) {
+        writeArrow(table, out);
+        return;
+    }
+    exportRows(table, format, 0, table.rowCount(), true, out);
+}
+
+uint64_t exportRows(TruthTable& table, ExportFormat format, uint64_t first,
+                    uint64_t last, bool header, OutputBuffer& out) {
+    auto layout = makeLayout(table, format);
+    if (header) {
+        out.append(layout.header);
+    }
+
+    const size_t n = table.variableCount();
+    std::vector<std::string> trueCells, falseCells;
+    for (size_t i = 0; i <= n; i++) {
+        trueCells.push_back(layout.prefix[i] + layout.trueText);
+        falseCells.push_back(layout.prefix[i] + layout.falseText);
+    }
+    trueCells[n] += layout.end;
+    falseCells[n] += layout.end;
+    RowFormatter formatter(trueCells, falseCells);
+    std::atomic<uint64_t> trueRows(0);
+    writeRows(
+        table, first, last,
+        [&](Simulator& sim, uint64_t from, uint64_t to, OutputBuffer& buffer) {
+            trueRows += appendRows(table, sim, formatter, from, to, buffer);
+        },
+        out);
+    return trueRows;
+}
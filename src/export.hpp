@@ -0,0 +1,25 @@
+#ifndef EXPORT_H
+#define EXPORT_H
+
+#include "outbuf.hpp"
+#include "truthtable.hpp"
+#include <string>
+
+// BITS is the compact plain text format pensieve prints when stdout is not a
+// terminal: a header naming the columns, then one line per row with a digit
+// per variable, a space and the result, like "0101 1".
+enum class ExportFormat { CSV, MARKDOWN, JSONL, ARROW, BITS };
+
+// Accepts csv, md (or markdown), jsonl, arrow and bits.
+bool parseExportFormat(const std::string& name, ExportFormat& format);
+
+// Streams the whole table into `out`, one row at a time straight from the
+// packed result words, so memory use does not grow with the row count.
+void exportTable(TruthTable& table, ExportFormat format, OutputBuffer& out);
+
+// Streams rows [first, last) in a text format (any but ARROW), preceded by
+// the header when `header` is set, and returns the number of true rows.
+uint64_t exportRows(TruthTable& table, ExportFormat format, uint64_t first,
+                    uint64_t last, bool header, OutputBuffer& out);
+
+#endif // EXPORT_H
@@ -0,0 +1,143 @@
+#include "flatbuf.hpp"
+#include <algorithm>
+
+FlatTable& FlatTable::table(size_t slot, FlatTable table) {
+    return child(slot, [table](FlatBuilder& out) { return table.write(out); });
+}
+
+FlatTable& FlatTable::string(size_t slot, const std::string& s) {
+    return child(slot, [s](FlatBuilder& out) {
+        out.align(4);
+        size_t pos = out.put<uint32_t>(s.size());
+        out.putBytes(s.data(), s.size());
+        out.put<char>('\0');
+        return pos;
+    });
+}
+
+FlatTable& FlatTable::tables(size_t slot, std::vector<FlatTable> tables) {
+    return child(slot, [tables](FlatBuilder& out) {
+        out.align(4);
+        size_t pos = out.put<uint32_t>(tables.size());
+        std::vector<size_t> offsets;
+        for (size_t i = 0; i < tables.size(); i++) {
+            offsets.push_back(out.put<uint32_t>(0));
+        }
+        for (size_t i = 0; i < tables.size(); i++) {
+            out.link(offsets[i], tables[i].write(out));
+        }
+        return pos;
+    });
+}
+
+size_t FlatTable::write(FlatBuilder& out) const {
+    // lay the fields out largest first after the vtable offset, each aligned
+    // to its size, with the table itself aligned to 8
+    std::vector<size_t> order(fields.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return fields[a].bytes.size() > fields[b].bytes.size();
+    });
+    std::vector<uint16_t> fieldOffsets(fields.size());
+    size_t tableSize = 4;
+    size_t slots = 0;
+    for (auto i : order) {
+        size_t width = fields[i].bytes.size();
+        tableSize = (tableSize + width - 1) / width * width;
+        fieldOffsets[i] = tableSize;
+        tableSize += width;
+        slots = std::max(slots, fields[i].slot + 1);
+    }
+
+    std::vector<uint16_t> vtable(2 + slots, 0);
+    vtable[0] = vtable.size() * 2;
+    vtable[1] = tableSize;
+    for (size_t i = 0; i < fields.size(); i++) {
+        vtable[2 + fields[i].slot] = fieldOffsets[i];
+    }
+    out.align(2);
+    while ((out.size() + vtable.size() * 2) % 8 != 0) {
+        out.put<uint16_t>(0);
+    }
+    size_t vtablePos = out.size();
+    out.putBytes(vtable.data(), vtable.size() * 2);
+
+    size_t tablePos = out.size();
+    out.data().resize(tablePos + tableSize, '\0');
+    out.patch<int32_t>(tablePos, tablePos - vtablePos);
+    for (size_t i = 0; i < fields.size(); i++) {
+        std::memcpy(&out.data()[tablePos + fieldOffsets[i]],
+                    fields[i].bytes.data(), fields[i].bytes.size());
+    }
+    for (size_t i = 0; i < fields.size(); i++) {
+        if (fields[i].child) {
+            size_t at = tablePos + fieldOffsets[i];
+            out.link(at, fields[i].child(out));
+        }
+    }
+    return tablePos;
+}
+
+std::string finishFlatBuffer(const FlatTable& root) {
+    FlatBuilder out;
+    out.put<uint32_t>(0);
+    out.link(0, root.write(out));
+    return out.data();
+}
+
+FlatView::FlatView(const uint8_t* buf, size_t size, size_t tablePos)
+    : buf(buf), size(size), tablePos(tablePos) {
+    check(tablePos, 4);
+}
+
+FlatView FlatView::root(const uint8_t* buf, size_t size) {
+    FlatView view(buf, size, 0);
+    return FlatView(buf, size, view.load<uint32_t>(0));
+}
+
+size_t FlatView::fieldPos(size_t slot) const {
+    int64_t vtable = (int64_t)tablePos - load<int32_t>(tablePos);
+    if (vtable < 0) {
+        throw std::runtime_error("malformed flatbuffer");
+    }
+    auto vtableSize = load<uint16_t>(vtable);
+    if (4 + 2 * slot + 2 > vtableSize) {
+        return 0;
+    }
+    auto offset = load<uint16_t>(vtable + 4 + 2 * slot);
+    return offset ? tablePos + offset : 0;
+}
+
+size_t FlatView::follow(size_t slot) const {
+    size_t pos = fieldPos(slot);
+    if (pos == 0) {
+        throw std::runtime_error("malformed flatbuffer: missing field");
+    }
+    return pos + load<uint32_t>(pos);
+}
+
+FlatView FlatView::table(size_t slot) const {
+    return FlatView(buf, size, follow(slot));
+}
+
+std::string FlatView::string(size_t slot) const {
+    size_t pos = follow(slot);
+    auto length = load<uint32_t>(pos);
+    check(pos + 4, length);
+    return std::string(reinterpret_cast<const char*>(buf + pos + 4), length);
+}
+
+size_t FlatView::vectorLength(size_t slot) const {
+    return has(slot) ? load<uint32_t>(follow(slot)) : 0;
+}
+
+FlatView FlatView::tableAt(size_t slot, size_t i) const {
+    size_t pos = follow(slot);
+    if (i >= load<uint32_t>(pos)) {
+        throw std::runtime_error("malformed flatbuffer");
+    }
+    size_t at = pos + 4 + 4 * i;
+    return FlatView(buf, size, at + load<uint32_t>(at));
+}
@@ -0,0 +1,140 @@
+#ifndef FLATBUF_H
+#define FLATBUF_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Just enough of the FlatBuffers wire format to write and read the Arrow IPC
+// metadata without generated code or the flatbuffers library: tables with
+// scalar fields, strings, vectors of structs and vectors of tables. Unions
+// are a ubyte type field plus a table field in the next slot.
+
+// Byte buffer written front to back. Offsets (uoffset_t) must point forward,
+// so an object is written after the fields referring to it and the offsets
+// are patched once its position is known.
+class FlatBuilder {
+private:
+    std::string buf;
+
+public:
+    size_t size() const { return buf.size(); }
+    std::string& data() { return buf; }
+
+    void align(size_t alignment) {
+        buf.resize((buf.size() + alignment - 1) / alignment * alignment, '\0');
+    }
+    template <class T> size_t put(const T& value) {
+        size_t pos = buf.size();
+        buf.append(reinterpret_cast<const char*>(&value), sizeof(T));
+        return pos;
+    }
+    void putBytes(const void* data, size_t size) {
+        buf.append(static_cast<const char*>(data), size);
+    }
+    template <class T> void patch(size_t at, const T& value) {
+        std::memcpy(&buf[at], &value, sizeof(T));
+    }
+    // Points the offset field at `from` to the object starting at `to`.
+    void link(size_t from, size_t to) { patch<uint32_t>(from, to - from); }
+};
+
+// A table described field by field. Objects the table refers to are written
+// right after it by callbacks that return where the object starts.
+class FlatTable {
+private:
+    using Writer = std::function<size_t(FlatBuilder&)>;
+    struct Field {
+        size_t slot;
+        std::string bytes;
+        Writer child;
+    };
+    std::vector<Field> fields;
+
+public:
+    template <class T> FlatTable& scalar(size_t slot, T value) {
+        fields.push_back(
+            {slot, std::string(reinterpret_cast<const char*>(&value), sizeof(T)),
+             nullptr});
+        return *this;
+    }
+    FlatTable& child(size_t slot, Writer write) {
+        fields.push_back({slot, std::string(4, '\0'), write});
+        return *this;
+    }
+    FlatTable& table(size_t slot, FlatTable table);
+    FlatTable& string(size_t slot, const std::string& s);
+    FlatTable& tables(size_t slot, std::vector<FlatTable> tables);
+    template <class T>
+    FlatTable& structs(size_t slot, const std::vector<T>& items) {
+        return child(slot, [items](FlatBuilder& out) {
+            // the elements are aligned to 8, the length precedes them
+            out.align(4);
+            if (out.size() % 8 == 0) {
+                out.put<uint32_t>(0);
+            }
+            size_t pos = out.put<uint32_t>(items.size());
+            out.putBytes(items.data(), items.size() * sizeof(T));
+            return pos;
+        });
+    }
+
+    // Writes the vtable, the table and then everything it refers to, and
+    // returns the position of the table.
+    size_t write(FlatBuilder& out) const;
+};
+
+// A complete buffer with `root` as its root table.
+std::string finishFlatBuffer(const FlatTable& root);
+
+// Bounds checked view of a table inside a FlatBuffer. Every accessor throws
+// std::runtime_error when the buffer is malformed.
+class FlatView {
+private:
+    const uint8_t* buf;
+    size_t size;
+    size_t tablePos;
+
+    FlatView(const uint8_t* buf, size_t size, size_t tablePos);
+    void check(size_t pos, size_t length) const {
+        if (pos > size || length > size - pos) {
+            throw std::runtime_error("malformed flatbuffer");
+        }
+    }
+    template <class T> T load(size_t pos) const {
+        check(pos, sizeof(T));
+        T value;
+        std::memcpy(&value, buf + pos, sizeof(T));
+        return value;
+    }
+    // position of a field, 0 when it is absent
+    size_t fieldPos(size_t slot) const;
+    size_t follow(size_t slot) const;
+
+public:
+    static FlatView root(const uint8_t* buf, size_t size);
+
+    bool has(size_t slot) const { return fieldPos(slot) != 0; }
+    template <class T> T scalar(size_t slot, T fallback) const {
+        size_t pos = fieldPos(slot);
+        return pos ? load<T>(pos) : fallback;
+    }
+    FlatView table(size_t slot) const;
+    std::string string(size_t slot) const;
+    // length of a vector field, 0 when it is absent
+    size_t vectorLength(size_t slot) const;
+    FlatView tableAt(size_t slot, size_t i) const;
+    template <class T> T structAt(size_t slot, size_t i) const {
+        size_t pos = follow(slot);
+        if (i >= load<uint32_t>(pos)) {
+            throw std::runtime_error("malformed flatbuffer");
+        }
+        return load<T>(pos + 4 + i * sizeof(T));
+    }
+};
+
+#endif // FLATBUF_H
@@ -0,0 +1,194 @@
+#include "fraig.hpp"
+#include <unordered_map>
+
+// number of 64 bit words of random patterns per node
+static const size_t RANDOM_WORDS = 4;
+
+Fraig::Fraig(const AIG& aig)
+    : aig(aig), encoder(reduced, solver), randomSim(aig, RANDOM_WORDS) {
+    std::mt19937_64 rng(0x2545f4914f6cdd1dull);
+    randomSim.randomizeInputs(rng);
+    randomSim.run();
+
+    nodeMap.assign(aig.nodeCount(), AIG_FALSE);
+    for (size_t i = 0; i < aig.inputCount(); i++) {
+        nodeMap[aig.inputNode(i)] = reduced.addInput(aig.inputName(i));
+    }
+}
+
+// Hash of the random simulation words, normalized so that a node and its
+// complement land in the same class.
+uint64_t Fraig::signature(uint32_t node) const {
+    auto words = randomSim.nodeWords(node);
+    uint64_t mask = phase(node) ? ~0ull : 0;
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t w = 0; w < RANDOM_WORDS; w++) {
+        hash = (hash ^ (words[w] ^ mask)) * 0x100000001b3ull;
+        hash ^= hash >> 29;
+    }
+    return hash;
+}
+
+// Whether two nodes agree, up to complementation, on every random pattern
+// and every counterexample found so far.
+bool Fraig::sameSignature(uint32_t a, uint32_t b) const {
+    uint64_t mask = phase(a) != phase(b) ? ~0ull : 0;
+    auto wordsA = randomSim.nodeWords(a);
+    auto wordsB = randomSim.nodeWords(b);
+    for (size_t w = 0; w < RANDOM_WORDS; w++) {
+        if (wordsA[w] != (wordsB[w] ^ mask)) {
+            return false;
+        }
+    }
+    for (size_t s = 0; s < counterexampleSims.size(); s++) {
+        // only the filled bits of the last batch are meaningful
+        size_t filled = counterexampleCount - 64 * s;
+        uint64_t valid = filled >= 64 ? ~0ull : (1ull << filled) - 1;
+        auto x = counterexampleSims[s].nodeWords(a)[0];
+        auto y = counterexampleSims[s].nodeWords(b)[0] ^ mask;
+        if ((x ^ y) & valid) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<bool> Fraig::modelInputs() const {
+    std::vector<bool> inputs(aig.inputCount(), false);
+    for (size_t i = 0; i < aig.inputCount(); i++) {
+        auto node = reduced.inputNode(i);
+        if (encoder.isEncoded(node)) {
+            inputs[i] = solver.modelValue(satMakeLit(encoder.nodeVar(node)));
+        }
+    }
+    return inputs;
+}
+
+// Simulates the last satisfying assignment on the original AIG so that later
+// candidate checks are refined by it.
+void Fraig::addCounterexample() {
+    size_t bit = counterexampleCount % 64;
+    if (bit == 0) {
+        counterexampleSims.emplace_back(aig, 1);
+    }
+    auto& sim = counterexampleSims.back();
+    auto inputs = modelInputs();
+    for (size_t i = 0; i < aig.inputCount(); i++) {
+        auto word = sim.inputWords(i);
+        *word = (*word & ~(1ull << bit)) | ((uint64_t)inputs[i] << bit);
+    }
+    sim.run();
+    counterexampleCount++;
+}
+
+SatResult Fraig::prove(AigLit a, AigLit b) {
+    auto solves = solver.getStats().solves;
+    auto result = encoder.checkEquivalence(a, b);
+    stats.satCalls += solver.getStats().solves - solves;
+    return result;
+}
+
+void Fraig::sweep(const std::vector<AigLit>& roots) {
+    std::vector<bool> inCone(aig.nodeCount(), false);
+    uint32_t highest = 0;
+    for (auto lit : roots) {
+        inCone[aigNode(lit)] = true;
+        highest = std::max(highest, aigNode(lit));
+    }
+    for (int64_t idx = highest; idx > 0; idx--) {
+        if (inCone[idx] && aig.isAnd(idx)) {
+            inCone[aigNode(aig.node(idx).fanin0)] = true;
+            inCone[aigNode(aig.node(idx).fanin1)] = true;
+        }
+    }
+    stats.andsBefore = aig.coneSize(roots);
+
+    // the constant and the inputs are the first members of their classes
+    std::unordered_map<uint64_t, std::vector<uint32_t>> classes;
+    classes[signature(0)].push_back(0);
+    for (size_t i = 0; i < aig.inputCount(); i++) {
+        classes[signature(aig.inputNode(i))].push_back(aig.inputNode(i));
+    }
+
+    solver.setConflictLimit(conflictLimit);
+    for (uint32_t idx = 1; idx <= highest; idx++) {
+        if (!inCone[idx] || !aig.isAnd(idx)) {
+            continue;
+        }
+        const auto& node = aig.node(idx);
+        auto lit = reduced.makeAnd(mapped(node.fanin0), mapped(node.fanin1));
+        nodeMap[idx] = lit;
+
+        auto& members = classes[signature(idx)];
+        bool merged = false;
+        bool searching = true;
+        while (searching) {
+            searching = false;
+            for (auto member : members) {
+                if (!sameSignature(idx, member)) {
+                    continue;
+                }
+                auto candidate =
+                    aigNotIf(nodeMap[member], phase(member) != phase(idx));
+                if (candidate == lit) {
+                    stats.structural++;
+                    merged = true;
+                    break;
+                }
+                auto result = prove(lit, candidate);
+                if (result == SatResult::UNSATISFIABLE) {
+                    stats.proven++;
+                    nodeMap[idx] = candidate;
+                    merged = true;
+                } else if (result == SatResult::SATISFIABLE) {
+                    // the counterexample separates the pair, look again
+                    stats.refuted++;
+                    addCounterexample();
+                    searching = true;
+                } else {
+                    stats.undecided++;
+                }
+                break;
+            }
+        }
+        if (!merged) {
+            members.push_back(idx);
+        }
+    }
+    solver.setConflictLimit(-1);
+
+    std::vector<AigLit> reducedRoots;
+    for (auto lit : roots) {
+        reducedRoots.push_back(mapped(lit));
+    }
+    stats.andsAfter = reduced.coneSize(reducedRoots);
+}
+
+bool Fraig::equivalent(AigLit a, AigLit b, std::vector<bool>& counterexample) {
+    // a difference on a simulated pattern needs no SAT call
+    auto wordsA = randomSim.nodeWords(aigNode(a));
+    auto wordsB = randomSim.nodeWords(aigNode(b));
+    uint64_t mask = aigIsComplemented(a) != aigIsComplemented(b) ? ~0ull : 0;
+    for (size_t w = 0; w < RANDOM_WORDS; w++) {
+        auto diff = wordsA[w] ^ wordsB[w] ^ mask;
+        if (diff) {
+            int bit = __builtin_ctzll(diff);
+            counterexample.assign(aig.inputCount(), false);
+            for (size_t i = 0; i < aig.inputCount(); i++) {
+                auto in = randomSim.nodeWords(aig.inputNode(i))[w];
+                counterexample[i] = (in >> bit) & 1;
+            }
+            return false;
+        }
+    }
+
+    if (mapped(a) == mapped(b)) {
+        return true;
+    }
+    auto result = prove(mapped(a), mapped(b));
+    if (result == SatResult::SATISFIABLE) {
+        counterexample = modelInputs();
+        return false;
+    }
+    return true;
+}
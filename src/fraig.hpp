@@ -0,0 +1,71 @@
+#ifndef FRAIG_H
+#define FRAIG_H
+
+#include "aig.hpp"
+#include "cnf.hpp"
+#include "simulator.hpp"
+#include "solver.hpp"
+#include <vector>
+
+struct FraigStats {
+    size_t satCalls = 0;
+    size_t proven = 0;
+    size_t refuted = 0;
+    size_t undecided = 0;
+    size_t structural = 0;
+    size_t andsBefore = 0;
+    size_t andsAfter = 0;
+};
+
+// SAT sweeping (functional reduction) of an AIG.
+//
+// Random simulation signatures split the nodes into candidate equivalence
+// classes. Nodes are then rebuilt bottom up into a reduced AIG, and every
+// node whose class holds an earlier member is checked against it with one
+// incremental solver: proven pairs are merged, and counterexamples are
+// simulated to refine the classes. Because fanins are merged first, most
+// checks only need to reason about a few gates close to the pair.
+class Fraig {
+private:
+    const AIG& aig;
+    AIG reduced;
+    Solver solver;
+    CnfEncoder encoder;
+    Simulator randomSim;
+    // counterexamples found so far, 64 per simulator
+    std::vector<Simulator> counterexampleSims;
+    size_t counterexampleCount = 0;
+    std::vector<AigLit> nodeMap;
+    FraigStats stats;
+
+    bool phase(uint32_t node) const { return randomSim.nodeWords(node)[0] & 1; }
+    uint64_t signature(uint32_t node) const;
+    bool sameSignature(uint32_t a, uint32_t b) const;
+    SatResult prove(AigLit a, AigLit b);
+    void addCounterexample();
+    std::vector<bool> modelInputs() const;
+
+public:
+    // Conflicts allowed when proving a pair of internal nodes; harder pairs
+    // are left unmerged.
+    int64_t conflictLimit = 1000;
+
+    Fraig(const AIG& aig);
+
+    // Sweeps the transitive fanin cone of the roots.
+    void sweep(const std::vector<AigLit>& roots);
+    // Literal in the reduced AIG that a literal of the original maps to.
+    AigLit mapped(AigLit lit) const {
+        return aigNotIf(nodeMap[aigNode(lit)], aigIsComplemented(lit));
+    }
+
+    // Decides whether `a` and `b` of the original AIG are equivalent. When
+    // they are not, `counterexample` receives input values telling them
+    // apart. Call after sweep() on a cone containing both.
+    bool equivalent(AigLit a, AigLit b, std::vector<bool>& counterexample);
+
+    const AIG& getReduced() const { return reduced; }
+    const FraigStats& getStats() const { return stats; }
+};
+
+#endif // FRAIG_H
@@ -0,0 +1,215 @@
+#include "ingest.hpp"
+#include "arena.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "stringutils.hpp"
+#include "symbols.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <fcntl.h>
+#include <mutex>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+// A read only mapping of a whole file, empty files are not mapped at all.
+class MappedFile {
+private:
+    int fd = -1;
+    const char* base = nullptr;
+    size_t size = 0;
+
+public:
+    MappedFile(const std::string& path) {
+        fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("cannot open " + path + ": " +
+                                     std::strerror(errno));
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            auto error = std::runtime_error("cannot stat " + path + ": " +
+                                            std::strerror(errno));
+            ::close(fd);
+            throw error;
+        }
+        size = st.st_size;
+        if (size == 0) {
+            return;
+        }
+        void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (mapped == MAP_FAILED) {
+            auto error = std::runtime_error("cannot map " + path + ": " +
+                                            std::strerror(errno));
+            ::close(fd);
+            throw error;
+        }
+        base = static_cast<const char*>(mapped);
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() {
+        if (base) {
+            ::munmap(const_cast<char*>(base), size);
+        }
+        ::close(fd);
+    }
+
+    const char* data() const { return base; }
+    size_t getSize() const { return size; }
+};
+
+// What a worker found in one chunk, with line numbers counted from the
+// start of the chunk.
+struct ChunkResult {
+    size_t lines = 0;
+    size_t expressions = 0;
+    size_t tokens = 0;
+    size_t nodes = 0;
+    std::vector<FileDiagnostic> diagnostics;
+};
+
+// The state a worker keeps across the chunks it takes.
+struct IngestWorker {
+    Arena arena;
+    SymbolTable names;
+    // a lowercased copy of the current line, when it has capitals
+    std::string lowered;
+
+    void parseLine(std::string_view line, ChunkResult& result);
+};
+
+void IngestWorker::parseLine(std::string_view line, ChunkResult& result) {
+    std::string_view rest = trimmed(line);
+    if (rest.empty() || rest[0] == '/') {
+        return;
+    }
+    // expressions are case insensitive, the mapping is read only
+    if (std::any_of(line.begin(), line.end(),
+                    [](char c) { return c >= 'A' && c <= 'Z'; })) {
+        lowered.assign(line);
+        std::transform(lowered.begin(), lowered.end(), lowered.begin(),
+                       [](unsigned char c) { return std::tolower(c); });
+        line = lowered;
+    }
+
+    ListSplitter splitter(line);
+    for (std::string_view expr; splitter.next(expr);) {
+        arena.reset();
+        result.expressions++;
+        const size_t column = expr.data() - line.data() + 1;
+        Lexer lexer(expr, &arena, names);
+        auto tokens = lexer.tokenize();
+        for (auto& diagnostic : lexer.getDiagnostics()) {
+            result.diagnostics.push_back(FileDiagnostic{
+                result.lines, column + diagnostic.offset, diagnostic.message});
+        }
+        if (tokens.size() == 0) {
+            continue;
+        }
+        result.tokens += tokens.size();
+        try {
+            result.nodes +=
+                Parser(tokens, &arena, names).parse().getNodes().size();
+        } catch (const std::runtime_error& e) {
+            result.diagnostics.push_back(
+                FileDiagnostic{result.lines, column, e.what()});
+        }
+    }
+}
+
+IngestStats ingestFile(const std::string& path, size_t threads,
+                       std::vector<FileDiagnostic>& diagnostics) {
+    auto start = std::chrono::steady_clock::now();
+    MappedFile file(path);
+    const char* base = file.data();
+    const size_t size = file.getSize();
+
+    // the start of the first line beginning at or after `offset`
+    auto lineStart = [&](size_t offset) -> size_t {
+        if (offset == 0 || offset >= size) {
+            return std::min(offset, size);
+        }
+        const void* newline =
+            std::memchr(base + offset - 1, '\n', size - offset + 1);
+        return newline ? static_cast<const char*>(newline) - base + 1 : size;
+    };
+
+    const size_t chunks = (size + INGEST_CHUNK_BYTES - 1) / INGEST_CHUNK_BYTES;
+    std::vector<ChunkResult> results(chunks);
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = std::max<size_t>(1, std::min(threads, chunks));
+
+    std::atomic<size_t> nextChunk(0);
+    std::mutex mutex;
+    std::exception_ptr error;
+    SymbolTable variables;
+    auto work = [&]() {
+        try {
+            IngestWorker worker;
+            for (size_t c; (c = nextChunk++) < chunks;) {
+                auto& result = results[c];
+                const char* p = base + lineStart(c * INGEST_CHUNK_BYTES);
+                const char* end = base + lineStart((c + 1) * INGEST_CHUNK_BYTES);
+                while (p < end) {
+                    auto newline = static_cast<const char*>(
+                        std::memchr(p, '\n', end - p));
+                    const char* lineEnd = newline ? newline : end;
+                    result.lines++;
+                    worker.parseLine(std::string_view(p, lineEnd - p), result);
+                    p = lineEnd + 1;
+                }
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            for (size_t id = 0; id < worker.names.size(); id++) {
+                variables.intern(worker.names.name(id));
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+            // the other workers run out of chunks
+            nextChunk = chunks;
+        }
+    };
+    std::vector<std::thread> pool;
+    for (size_t i = 0; i < threads; i++) {
+        pool.emplace_back(work);
+    }
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    IngestStats stats;
+    stats.bytes = size;
+    stats.threads = threads;
+    diagnostics.clear();
+    for (auto& result : results) {
+        for (auto& diagnostic : result.diagnostics) {
+            diagnostic.line += stats.lines;
+            diagnostics.push_back(std::move(diagnostic));
+        }
+        stats.lines += result.lines;
+        stats.expressions += result.expressions;
+        stats.tokens += result.tokens;
+        stats.nodes += result.nodes;
+    }
+    stats.variables = variables.size();
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    stats.seconds = elapsed.count();
+    return stats;
+}
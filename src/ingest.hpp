@@ -0,0 +1,44 @@
+#ifndef INGEST_H
+#define INGEST_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// An error in an expression file, at a line and a byte column (both
+// counted from 1).
+struct FileDiagnostic {
+    size_t line;
+    size_t column;
+    std::string message;
+};
+
+struct IngestStats {
+    size_t bytes = 0;
+    size_t lines = 0;
+    size_t expressions = 0;
+    size_t tokens = 0;
+    // syntax tree nodes of the valid expressions
+    size_t nodes = 0;
+    // distinct variable names over the whole file
+    size_t variables = 0;
+    size_t threads = 0;
+    double seconds = 0;
+};
+
+// Lexes and parses every expression of a file, one comma separated list per
+// line as typed at the prompt (blank lines and commands are skipped),
+// without evaluating any of them.
+//
+// The file is memory-mapped and cut into chunks of INGEST_CHUNK_BYTES. A
+// pool of `threads` workers (all the cores when 0) takes the chunks in
+// turn. Each worker moves the ends of its chunk to the next line ends
+// itself, so lines are never split, and lexes and parses into an arena and
+// a symbol table of its own. Diagnostics are returned in file order.
+// Throws std::runtime_error when the file cannot be read.
+IngestStats ingestFile(const std::string& path, size_t threads,
+                       std::vector<FileDiagnostic>& diagnostics);
+
+const size_t INGEST_CHUNK_BYTES = 1 << 20;
+
+#endif // INGEST_H
@@ -1,29 +1,52 @@
 #include "interpreter.hpp"
 #include "constants.hpp"
+#include "export.hpp"
+#include "parser.hpp"
+#include "renderer.hpp"
+#include "symbols.hpp"
 #include "tabulate.hpp"
+#include "truthtable.hpp"
 #include <algorithm>
 #include <cmath>
 #include <sstream>
 #include <stdexcept>
 #include <unordered_map>
-#include <unordered_set>
-
-std::vector<Token> Interpreter::getVariableTokens() {
-    std::vector<Token> variableTokens;
-    std::unordered_set<std::string> seenNames;
-
-    for (auto& tok : infixTokens) {
-        if (tok.isVariable() &&
-            (seenNames.find(tok.getValue()) == seenNames.end())) {
-            variableTokens.push_back(tok);
-            seenNames.insert(tok.getValue());
+#include <utility>
+#include <unistd.h>
+
+// Lists the variables in the order they first appear in the expression,
+// which is the order of their nodes, and gives each variable node the
+// column of its variable. Symbols are mapped to columns through a table of
+// this expression's own symbols, so the cost does not grow with the number
+// of names interned in the session.
+void Interpreter::collectVariables() {
+    auto& nodes = ast.getNodes();
+    auto memory = nodeColumns.get_allocator().resource();
+    std::pmr::unordered_map<uint32_t, uint32_t> columns(memory);
+    nodeColumns.resize(nodes.size());
+    for (size_t i = 0; i < nodes.size(); i++) {
+        if (nodes[i].type != TokenType::VARIABLE) {
+            continue;
         }
+        auto [it, added] =
+            columns.try_emplace(nodes[i].symbol, variableSymbols.size());
+        if (added) {
+            variableSymbols.push_back(nodes[i].symbol);
+        }
+        nodeColumns[i] = it->second;
+    }
+}
+
+std::vector<std::string> Interpreter::getVariableNames() const {
+    std::vector<std::string> names;
+    for (auto symbol : variableSymbols) {
+        names.push_back(ast.getSymbols().name(symbol));
     }
-    return std::vector<Token>(variableTokens.begin(), variableTokens.end());
+    return names;
 }
 
 void Interpreter::generateInitialMatrix() {
-    int varCount = this->variableNames.size();
+    int varCount = variableCount();
     if (varCount == 0)
         return; // No variables, no matrix
 
@@ -45,285 +68,239 @@ void Interpreter::generateInitialMatrix() {
     }
 }
 
-void Interpreter::convertToPostfix() {
-    for (auto& token : infixTokens) {
-        auto tokenType = token.getTokenType();
-        auto tokenPrecedence = token.getPrecedence();
-        auto tokenAssoc = token.getAssociativity();
-
-        if (tokenType == TokenType::VARIABLE) {
-            postfixTokens.push_back(token);
-        } else {
-            if (operatorStack.empty() || tokenType == TokenType::LPAREN) {
-                operatorStack.push(token);
-                continue;
-            }
-            if (tokenType == TokenType::RPAREN) {
-                while (operatorStack.top().getTokenType() !=
-                       TokenType::LPAREN) {
-                    postfixTokens.push_back(operatorStack.top());
-                    operatorStack.pop();
-                    // we need not worry about stack being empty because
-                    // lparen is 100% present due to checking by lexer
-                }
-                operatorStack.pop(); // remove LPAREN from operator stack
-                continue;
-            }
-            auto topOperator = operatorStack.top();
-            if (tokenPrecedence > topOperator.getPrecedence()) {
-                operatorStack.push(token);
-            } else if (tokenPrecedence < topOperator.getPrecedence()) {
-                while (operatorStack.top().getPrecedence() >= tokenPrecedence) {
-                    postfixTokens.push_back(operatorStack.top());
-                    operatorStack.pop();
-                    if (operatorStack.empty()) {
-                        break;
-                    }
-                }
-                operatorStack.push(token);
-            } else {
-                if (tokenAssoc == Associativity::LEFT) {
-                    postfixTokens.push_back(operatorStack.top());
-                    operatorStack.pop();
-                    operatorStack.push(token);
-                } else {
-                    operatorStack.push(token);
-                }
-            }
-        }
-    }
-
-    while (!operatorStack.empty()) {
-        postfixTokens.push_back(operatorStack.top());
-        operatorStack.pop();
-    }
-}
-
-long double Interpreter::resolveOperator(Token token,
-                                         std::stack<bool>& operands) {
-
-    auto tokenType = token.getTokenType();
-
-    // Handle unary operators (like negation)
-    if (token.isUnaryOperator()) {
-        if (operands.empty()) {
-            throw std::runtime_error(
-                "Invalid expression: not enough operands for unary operator");
+uint64_t Interpreter::evaluateWord(uint64_t w) {
+    auto& nodes = ast.getNodes();
+    const size_t n = variableCount();
+    for (size_t i = 0; i < nodes.size(); i++) {
+        auto& node = nodes[i];
+        switch (node.type) {
+        case TokenType::VARIABLE:
+            values[i] = TruthTable::variableWord(nodeColumns[i], n, w);
+            break;
+        case TokenType::NEGATION_OP:
+            values[i] = ~values[node.left];
+            break;
+        case TokenType::OR_OP:
+            values[i] = values[node.left] | values[node.right];
+            break;
+        case TokenType::AND_OP:
+            values[i] = values[node.left] & values[node.right];
+            break;
+        case TokenType::XOR_OP:
+            values[i] = values[node.left] ^ values[node.right];
+            break;
+        case TokenType::IMLPICATION_OP:
+            values[i] = ~values[node.left] | values[node.right];
+            break;
+        case TokenType::BICONDITIONAL_OP:
+            values[i] = ~(values[node.left] ^ values[node.right]);
+            break;
+        default:
+            throw std::logic_error("Unknown token type to evaluate");
         }
-        auto value = operands.top();
-        operands.pop();
-        // For NOT operation, invert the boolean value
-        return !value;
-    }
-
-    // Handle binary operators
-    if (operands.size() < 2) {
-        throw std::runtime_error(
-            "Invalid expression: not enough operands for binary operator");
-    }
-
-    auto num2 = operands.top();
-    operands.pop();
-    auto num1 = operands.top();
-    operands.pop();
-
-    switch (tokenType) {
-    case TokenType::OR_OP:
-        return (num1 || num2);
-    case TokenType::AND_OP:
-        return (num1 && num2);
-    case TokenType::XOR_OP:
-        return (num1 != num2);
-    case TokenType::IMLPICATION_OP:
-        return !(num1 && !num2);
-    case TokenType::BICONDITIONAL_OP:
-        return num1 == num2;
-    default:
-        throw std::logic_error("Unknown token type to resolve");
     }
+    return n < 6 ? values.back() & ((1ull << (1u << n)) - 1) : values.back();
 }
 
-bool Interpreter::evalPostfix(int rowIdx) {
-    std::stack<bool> operands;
-    std::unordered_map<std::string, int> variablePositions;
-
-    // First, build a map of variable names to their positions in variableNames
-    for (int i = 0; i < variableNames.size(); i++) {
-        variablePositions[variableNames[i]] = i;
-    }
-
-    // Now evaluate the postfix expression
-    for (auto& token : postfixTokens) {
-        if (token.isVariable()) {
-            // Look up the variable position and get its value from the result
-            // matrix
-            auto varName = token.getValue();
-            if (variablePositions.find(varName) == variablePositions.end()) {
-                throw std::runtime_error("Unknown variable: " + varName);
-            }
-            int varPos = variablePositions[varName];
-            if (varPos >= resultMatrix.size() ||
-                rowIdx >= resultMatrix[varPos].size()) {
-                throw std::runtime_error(
-                    "Matrix index out of bounds for variable: " + varName);
-            }
-            operands.push(resultMatrix[varPos][rowIdx]);
-        } else {
-            // Apply operator
-            bool result = resolveOperator(token, operands);
-            operands.push(result);
-        }
-    }
-
-    if (operands.empty()) {
-        throw std::runtime_error(
-            "Invalid expression: evaluation resulted in no value");
+// The result column heading of a table on a terminal. Every row of the
+// table is as wide as the heading, so long expressions are cut short in the
+// middle.
+static std::string resultHeading(const std::string& expr) {
+    const size_t width = Interpreter::HEADING_WIDTH;
+    if (expr.size() <= width) {
+        return expr;
     }
-
-    return operands.top();
+    const size_t head = (width - 5) / 2;
+    return expr.substr(0, head) + " ... " +
+           expr.substr(expr.size() - (width - 5 - head));
 }
 
-std::vector<bool> Interpreter::displayResultMatrix() {
-    if (resultMatrix.empty() || variableNames.empty()) {
+void Interpreter::displayResultMatrix() {
+    if (variableSymbols.empty()) {
         std::cout << "No variables to display in truth table." << std::endl;
-        return std::vector<bool>{};
+        return;
     }
-
-    tabulate::Table truthTable;
-
-    // Add header row with variable names
-    auto headerRow = tabulate::RowStream{};
-    for (const auto& name : variableNames) {
-        headerRow << name;
+    // the row count would not fit in 64 bits, the expression can still be
+    // checked for equivalence
+    if (variableCount() > TruthTable::MAX_VARIABLES) {
+        std::cout << red("too many variables for a truth table (" +
+                         std::to_string(variableCount()) + ", at most " +
+                         std::to_string(TruthTable::MAX_VARIABLES) + ")")
+                  << std::endl;
+        return;
     }
     auto expr = getInfix();
-    headerRow << expr;
-    truthTable.add_row(headerRow);
-
-    // Format header row
-    truthTable.row(0)
-        .format()
-        .font_style({tabulate::FontStyle::bold})
-        .font_align(tabulate::FontAlign::center);
+    const uint64_t rowCount = 1ull << variableCount();
+
+    // counted while the rows are printed, the column is never kept
+    uint64_t trueRows = 0;
+    bool printed = false;
+    if (!isatty(STDOUT_FILENO)) {
+        trueRows = printPlainTable();
+        printed = true;
+    } else if (rowCount > TableRenderer::TABULATE_ROWS) {
+        printed = renderLargeTable(trueRows);
+    }
+    if (!printed) {
+        generateInitialMatrix();
 
-    // Get the number of rows in the truth table
-    int numRows = resultMatrix[0].size();
+        // Get the number of rows in the truth table
+        int numRows = resultMatrix[0].size();
 
-    // Add data rows
-    std::vector<bool> resultCol;
-    for (int rowIdx = 0; rowIdx < numRows; rowIdx++) {
-        auto dataRow = tabulate::RowStream{};
-        for (int colIdx = 0; colIdx < resultMatrix.size(); colIdx++) {
-            dataRow << (resultMatrix[colIdx][rowIdx] ? "true" : "false");
+        // the results, 64 rows per pass over the syntax tree
+        std::vector<uint64_t> words((numRows + 63) / 64);
+        for (size_t w = 0; w < words.size(); w++) {
+            words[w] = evaluateWord(w);
+            trueRows += __builtin_popcountll(words[w]);
         }
-        auto result = evalPostfix(rowIdx);
-        resultCol.push_back(result);
-        dataRow << (result ? "true" : "false");
-        truthTable.add_row(dataRow);
-    }
 
-    // Apply cell-level formatting
-    // Format column headers
-    for (size_t i = 0; i < variableNames.size(); i++) {
-        truthTable[0][i].format().font_color(tabulate::Color::blue);
-    }
-    // Format the expression header
-    truthTable[0][variableNames.size()].format().font_color(
-        tabulate::Color::magenta);
-
-    // Format data cells
-    for (int rowIdx = 0; rowIdx < numRows; rowIdx++) {
-        // Format variable columns
-        for (int colIdx = 0; colIdx < resultMatrix.size(); colIdx++) {
-            bool cellValue = resultMatrix[colIdx][rowIdx];
-            truthTable[rowIdx + 1][colIdx]
-                .format()
-                .font_align(tabulate::FontAlign::center)
-                .font_color(cellValue ? tabulate::Color::green
-                                      : tabulate::Color::red);
+        // Collect the cell values of every row, the result last
+        std::vector<std::vector<bool>> rows;
+        for (int rowIdx = 0; rowIdx < numRows; rowIdx++) {
+            std::vector<bool> row;
+            for (size_t colIdx = 0; colIdx < resultMatrix.size(); colIdx++) {
+                row.push_back(resultMatrix[colIdx][rowIdx]);
+            }
+            bool result = (words[rowIdx / 64] >> (rowIdx % 64)) & 1;
+            row.push_back(result);
+            rows.push_back(row);
         }
 
-        // Format result column
-        bool resultValue = resultCol[rowIdx];
-        truthTable[rowIdx + 1][resultMatrix.size()]
-            .format()
-            .font_align(tabulate::FontAlign::center)
-            .font_color(resultValue ? tabulate::Color::green
-                                    : tabulate::Color::red)
-            .font_style({tabulate::FontStyle::bold});
+        // Print the table
+        std::cout << makeTruthTable(getVariableNames(), resultHeading(expr),
+                                    rows)
+                  << std::endl;
     }
 
-    // Print the table
-    std::cout << truthTable << std::endl;
-
     // check for all true or all false
-    bool allTrue = std::all_of(resultCol.begin(), resultCol.end(),
-                               [](bool val) { return val; });
-    bool allFalse = std::all_of(resultCol.begin(), resultCol.end(),
-                                [](bool val) { return !val; });
-    if (allTrue) {
-        std::cout << COLOR_YELLOW << "`" << expr << "` is a tautology"
-                  << COLOR_RESET << std::endl;
-    } else if (allFalse) {
-        std::cout << COLOR_YELLOW << "`" << expr << "` is a contradiction"
-                  << COLOR_RESET << std::endl;
+    if (trueRows == rowCount) {
+        std::cout << yellow("`" + expr + "` is a tautology") << std::endl;
+    } else if (trueRows == 0) {
+        std::cout << yellow("`" + expr + "` is a contradiction") << std::endl;
     }
-
-    return resultCol;
 }
 
-Interpreter::Interpreter(std::vector<Token> tokens) : infixTokens(tokens) {
-    convertToPostfix();
-    auto variableTokens = getVariableTokens();
-    std::vector<std::string> varNames(variableTokens.size());
-    std::transform(variableTokens.begin(), variableTokens.end(),
-                   varNames.begin(), [](Token t) { return t.getValue(); });
-    variableNames = varNames;
-    generateInitialMatrix();
+Interpreter::Interpreter(const TokenList& tokens,
+                         std::pmr::memory_resource* memory,
+                         const SymbolTable& names)
+    : ast(Parser(tokens, memory, names).parse()), variableSymbols(memory),
+      nodeColumns(memory), values(ast.getNodes().size(), memory) {
+    collectVariables();
 };
 
 std::string Interpreter::getPostfix() {
+    std::string postfix;
+    for (auto& node : ast.getNodes()) {
+        postfix += node.type == TokenType::VARIABLE
+                       ? ast.getSymbols().name(node.symbol)
+                       : TOKEN_TRAITS[(int)node.type].text;
+        postfix += ' ';
+    }
+    return postfix;
+}
+
+std::string Interpreter::getInfix() {
+    std::string infix;
+    ast.printInfix(infix);
+    return infix;
+}
+
+std::string Interpreter::getVariables() {
     std::stringstream ss;
-    for (auto& tok : postfixTokens) {
-        ss << tok.getValue() << " ";
+    for (auto& var : getVariableNames()) {
+        ss << var << " ";
     }
     return ss.str();
 }
 
-std::string Interpreter::getInfix() {
-    std::stack<std::string> expr;
-    for (auto& token : postfixTokens) {
-        if (token.isVariable()) {
-            expr.push(token.getValue());
-        } else if (token.isUnaryOperator()) {
-            // we have only one unary operator -> negation
-            auto e1 = expr.top();
-            expr.pop();
-            auto e = "!(" + e1 + ")";
-            expr.push(e);
-        } else {
-            auto e2 = expr.top();
-            expr.pop();
-            auto e1 = expr.top();
-            expr.pop();
-            auto e = "(" + e1 + " " + token.getValue() + " " + e2 + ")";
-            expr.push(e);
+// Lowers the postfix expression into the given AIG and returns the literal of
+// its output. Variables are matched by name against the AIG's inputs, so
+// several expressions can share one graph.
+AigLit Interpreter::buildAIG(AIG& aig) {
+    auto& nodes = ast.getNodes();
+    // scratch space from the interpreter's memory, like the rest of its
+    // state
+    auto memory = values.get_allocator().resource();
+    std::pmr::vector<AigLit> lits(nodes.size(), memory);
+    // each name is looked up in the AIG once, then by column
+    std::pmr::vector<AigLit> inputs(variableCount(), AIG_INPUT_MARK, memory);
+    for (size_t i = 0; i < nodes.size(); i++) {
+        auto& node = nodes[i];
+        const AigLit a = lits[node.left], b = lits[node.right];
+        switch (node.type) {
+        case TokenType::VARIABLE: {
+            auto& input = inputs[nodeColumns[i]];
+            if (input == AIG_INPUT_MARK) {
+                input = aig.namedInput(ast.getSymbols().name(node.symbol));
+            }
+            lits[i] = input;
+            break;
+        }
+        case TokenType::NEGATION_OP:
+            lits[i] = aigNot(a);
+            break;
+        case TokenType::OR_OP:
+            lits[i] = aig.makeOr(a, b);
+            break;
+        case TokenType::AND_OP:
+            lits[i] = aig.makeAnd(a, b);
+            break;
+        case TokenType::XOR_OP:
+            lits[i] = aig.makeXor(a, b);
+            break;
+        case TokenType::IMLPICATION_OP:
+            lits[i] = aig.makeImplication(a, b);
+            break;
+        case TokenType::BICONDITIONAL_OP:
+            lits[i] = aig.makeBiconditional(a, b);
+            break;
+        default:
+            throw std::logic_error("Unknown token type to lower");
         }
     }
-    return expr.top();
+    return lits.back();
 }
 
-std::string Interpreter::getVariables() {
+std::string Interpreter::getAIGSummary() {
+    AIG aig;
+    auto root = buildAIG(aig);
     std::stringstream ss;
-    for (auto& var : variableNames) {
-        ss << var << " ";
+    ss << aig.coneSize(root) << " and nodes, depth " << aig.depth(root);
+    if (root == AIG_TRUE || root == AIG_FALSE) {
+        ss << " (constant " << (root == AIG_TRUE ? "true" : "false") << ")";
     }
     return ss.str();
 }
 
-// Displays the truth table and returns the final result column.
-std::vector<bool> Interpreter::evaluate() {
-    return displayResultMatrix();
-    // return evalPostfix();
-    // return 0;
+// Prints the table for a pipe or a file in the compact BITS format, one
+// line per row, and returns the number of true rows.
+uint64_t Interpreter::printPlainTable() {
+    TruthTable table(*this);
+    std::cout.flush();
+    OutputBuffer out(STDOUT_FILENO);
+    uint64_t trueRows =
+        exportRows(table, ExportFormat::BITS, 0, table.rowCount(), true, out);
+    out.flush();
+    return trueRows;
+}
+
+// Prints a table too large for tabulate through the streaming renderer,
+// counting its true rows into `trueRows`. Returns false without printing
+// anything when the renderer cannot reproduce tabulate's layout.
+bool Interpreter::renderLargeTable(uint64_t& trueRows) {
+    TableRenderer renderer(getVariableNames(), resultHeading(getInfix()),
+                           isatty(STDOUT_FILENO));
+    if (!renderer.isValid()) {
+        return false;
+    }
+    TruthTable table(*this);
+    std::cout.flush();
+    OutputBuffer out(STDOUT_FILENO);
+    trueRows = renderer.render(table, out);
+    return true;
+}
+
+// Displays the truth table.
+void Interpreter::evaluate() {
+    displayResultMatrix();
 }
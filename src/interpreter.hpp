@@ -1,32 +1,53 @@
 #ifndef INTERPRETER_H
 #define INTERPRETER_H
 
+#include "aig.hpp"
+#include "ast.hpp"
 #include "tokens.hpp"
-#include <stack>
 #include <string>
 #include <vector>
 
 class Interpreter {
 private:
-    std::vector<Token> infixTokens;
-    std::vector<Token> postfixTokens;
-    std::stack<Token> operatorStack;
-    std::vector<std::string> variableNames;
+    Ast ast;
+    // the symbols of the variables in order of first appearance
+    std::pmr::vector<uint32_t> variableSymbols;
+    // the column of the variable of each variable node, indexed by node
+    std::pmr::vector<uint32_t> nodeColumns;
+    // the value of each node while evaluating
+    std::pmr::vector<uint64_t> values;
     std::vector<std::vector<bool>> resultMatrix;
 
-    std::vector<Token> getVariableTokens();
+    void collectVariables();
     void generateInitialMatrix();
-    void convertToPostfix();
-    long double resolveOperator(Token token, std::stack<bool>& operands);
-    bool evalPostfix(int rowIdx);
-    std::vector<bool> displayResultMatrix();
+    void displayResultMatrix();
+    uint64_t printPlainTable();
+    bool renderLargeTable(uint64_t& trueRows);
 
 public:
-    Interpreter(std::vector<Token> tokens);
+    // Longer expressions are shortened in the heading of tables printed to
+    // a terminal.
+    static const size_t HEADING_WIDTH = 100;
+
+    // The tokens must have been validated by the lexer, which interned
+    // their names into `names`. The syntax tree and the evaluation state are
+    // allocated from `memory`.
+    Interpreter(const TokenList& tokens,
+                std::pmr::memory_resource* memory =
+                    std::pmr::get_default_resource(),
+                const SymbolTable& names = symbols());
     std::string getPostfix();
     std::string getInfix();
     std::string getVariables();
-    std::vector<bool> evaluate();
+    std::vector<std::string> getVariableNames() const;
+    size_t variableCount() const { return variableSymbols.size(); }
+    AigLit buildAIG(AIG& aig);
+    std::string getAIGSummary();
+    void evaluate();
+    // Evaluates rows [64 * w, 64 * w + 64) of the truth table at once on the
+    // syntax tree, bit b for row 64 * w + b as in TruthTable, without
+    // allocating. Bits past the last row are zero.
+    uint64_t evaluateWord(uint64_t w);
 };
 
 #endif // INTERPRETER_H
@@ -1,116 +1,333 @@
 #include "lexer.hpp"
-#include <cctype>
+#include "charclass.hpp"
+#include "symbols.hpp"
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 
-void Lexer::advance() {
-    position++;
-    currentChar = infix.at(position);
+// identifiers are a lowercase letter or an underscore followed by any
+// number of lowercase letters, digits and underscores
+bool Lexer::isIdentifierStart(char c) const {
+    return (c >= 'a' && c <= 'z') || c == '_';
 }
 
-bool Lexer::isVariable(char c) { return c >= 'a' && c <= 'z'; }
+bool Lexer::isIdentifierChar(char c) const {
+    return isIdentifierStart(c) || (c >= '0' && c <= '9');
+}
+
+void Lexer::fail(std::string error, size_t offset) {
+    diagnostics.push_back(Diagnostic{offset, std::move(error)});
+}
 
-void Lexer::reportError(std::string error, int offset) {
-    if (offset < 0) {
-        offset = position;
+void Lexer::reportDiagnostics() const {
+    if (diagnostics.empty()) {
+        return;
+    }
+    if (infix.size() <= DIAGNOSTIC_WIDTH) {
+        std::cout << infix << "\n";
+        for (auto& diagnostic : diagnostics) {
+            std::cout << std::string(diagnostic.offset, ' ');
+            std::cout << red("^ " + diagnostic.message) << std::endl;
+        }
+        return;
+    }
+    // only the part of a long input around each error is shown
+    const size_t width = DIAGNOSTIC_WIDTH;
+    for (auto& diagnostic : diagnostics) {
+        size_t first =
+            diagnostic.offset - std::min(diagnostic.offset, width / 2);
+        size_t last = std::min(infix.size(), first + width);
+        std::string prefix = first > 0 ? "... " : "";
+        std::cout << prefix << infix.substr(first, last - first)
+                  << (last < infix.size() ? " ..." : "") << "\n";
+        std::cout << std::string(prefix.size() + diagnostic.offset - first, ' ');
+        std::cout << red("^ " + diagnostic.message + " (at byte " +
+                         std::to_string(diagnostic.offset) + ")")
+                  << std::endl;
     }
-    std::cout << infix << "\n";
-    std::cout << std::string(offset, ' ');
-    std::cout << COLOR_RED << "^ " << error << COLOR_RESET << std::endl;
 }
 
-Lexer::Lexer(const std::string& input) : infix(input) {
-    position = -1;
+Lexer::Lexer(std::string_view input, std::pmr::memory_resource* memory,
+             SymbolTable& names)
+    : infix(input), memory(memory), names(names), bracketPositions(memory),
+      identifiers(memory) {
     rank = 0;
 }
 
-std::vector<Token> Lexer::tokenize() {
-    std::vector<Token> tokens;
-    advance(); // not checking for exception here because empty input is
-               // ignored by the input loop
-    bool reachedEnd = false;
-    while (!reachedEnd) {
-        if (std::isspace(currentChar)) {
-            goto next;
-        }
-
-        if (currentChar == '|') {
-            tokens.push_back(OrToken());
-        } else if (currentChar == '!') {
-            tokens.push_back(NegationToken());
-        } else if (currentChar == '&') {
-            tokens.push_back(AndToken());
-        } else if (currentChar == '^') {
-            tokens.push_back(XorToken());
-        } else if (currentChar == '>') {
-            tokens.push_back(ImplicationToken());
-        } else if (currentChar == '=') {
-            tokens.push_back(BiconditionalToken());
-        } else if (currentChar == '(') {
-            tokens.push_back(LPARENToken());
-            bracketPositions.push(position);
-        } else if (currentChar == ')') {
-            if (bracketPositions.empty()) {
-                // no open bracket is set for this to close
-                reportError("missing opening parentheses");
-                return std::vector<Token>{};
+void Lexer::internIdentifiers(TokenList& tokens) {
+    size_t next = 0;
+    for (auto& token : tokens) {
+        if (token.isVariable()) {
+            auto [start, end] = identifiers[next++];
+            token = VariableToken(
+                names.intern(infix.substr(start, end - start)));
+        }
+    }
+}
+
+TokenList Lexer::tokenize() {
+    if (infix.size() >= BLOCK_BYTES) {
+        TokenList tokens(memory);
+        tokens.reserve(infix.size());
+        if (tokenizeBlocks(tokens)) {
+            return tokens;
+        }
+        identifiers.clear();
+    }
+    return tokenizeScalar();
+}
+
+// The token type of each operator and parenthesis, a table rather than a
+// switch since the operators of an expression follow no pattern the branch
+// predictor could learn.
+struct SymbolTypes {
+    TokenType of[256] = {};
+
+    constexpr SymbolTypes() {
+        of[(int)'|'] = TokenType::OR_OP;
+        of[(int)'!'] = TokenType::NEGATION_OP;
+        of[(int)'&'] = TokenType::AND_OP;
+        of[(int)'^'] = TokenType::XOR_OP;
+        of[(int)'>'] = TokenType::IMLPICATION_OP;
+        of[(int)'='] = TokenType::BICONDITIONAL_OP;
+        of[(int)'('] = TokenType::LPAREN;
+        of[(int)')'] = TokenType::RPAREN;
+    }
+};
+
+static constexpr SymbolTypes SYMBOL_TYPES;
+
+// Tokenizes the input a block of 64 bytes at a time. Every check is done on
+// the character class masks of a block before any of its tokens is made:
+//  - identifiers start where an identifier byte follows another byte, and
+//    must not start with a digit
+//  - a block can only close more parentheses than are open before it when
+//    its closing parentheses outnumber them, only then are they walked in
+//    order
+//  - operands and binary operators alternate (this is what the rank checks
+//    in the scalar pass amount to), so the operands are exactly the odd
+//    ones among both, which the prefix parity of their mask selects. The
+//    same parity tells where an operand may start with a negation or an
+//    opening parenthesis and where a closing parenthesis may end one
+// Returns false as soon as the input is found invalid, the scalar pass then
+// finds and reports the errors.
+bool Lexer::tokenizeBlocks(TokenList& tokens) {
+    const char* begin = infix.data();
+    const size_t size = infix.size();
+    auto addIdentifier = [&](size_t start, size_t end) {
+        tokens.push_back(VariableToken(0));
+        identifiers.emplace_back(start, end);
+    };
+
+    uint64_t identCarry = 0;
+    // all ones when an odd number of operands and binary operators were
+    // seen, so the next one must be an operator
+    uint64_t odd = 0;
+    size_t depth = 0;
+    // the start of an identifier running on into the next block
+    size_t pending = SIZE_MAX;
+    char tail[64];
+    for (size_t base = 0; base < size; base += 64) {
+        const char* block = begin + base;
+        if (size - base < 64) {
+            // pad the last block with spaces
+            std::memset(tail, ' ', sizeof(tail));
+            std::memcpy(tail, block, size - base);
+            block = tail;
+        }
+        CharClasses c;
+        classifyBlock(block, c);
+        if (~(c.space | c.ident | c.binary | c.negation | c.lparen |
+              c.rparen)) {
+            return false;
+        }
+        const uint64_t identStart = c.ident & ~((c.ident << 1) | identCarry);
+        identCarry = c.ident >> 63;
+        if (identStart & c.digit) {
+            return false;
+        }
+
+        const size_t closing = __builtin_popcountll(c.rparen);
+        if (closing > depth) {
+            for (uint64_t parens = c.lparen | c.rparen; parens;
+                 parens &= parens - 1) {
+                if (c.rparen & parens & -parens) {
+                    if (depth == 0) {
+                        return false;
+                    }
+                    depth--;
+                } else {
+                    depth++;
+                }
             }
-            tokens.push_back(RPARENToken());
-            bracketPositions.pop();
-        } else if (isVariable(currentChar)) {
-            auto tempToken = VariableToken(std::string(1, currentChar));
-            tokens.push_back(tempToken);
         } else {
-            reportError("invalid character");
-            return std::vector<Token>{};
-        }
-
-        {
-            // * new scope to allow control transfer from goto
-            auto lastToken = tokens.back();
-            auto isVariable = lastToken.isVariable();
-            auto isParen = lastToken.isParen();
-            auto isUnary = lastToken.isUnaryOperator();
-            if (isUnary) {
-                // ignore unary operators in rank calculation
-                goto next;
-            } else if (isVariable) {
-                rank++;
-            } else if (!isParen) {
-                rank--;
+            depth += __builtin_popcountll(c.lparen) - closing;
+        }
+
+        const uint64_t ranked = identStart | c.binary;
+        // set where an operator is expected
+        const uint64_t afterOperand = prefixXor(ranked) ^ odd;
+        if (identStart != (ranked & afterOperand) ||
+            ((c.lparen | c.negation) & afterOperand) ||
+            (c.rparen & ~afterOperand)) {
+            return false;
+        }
+        if (__builtin_popcountll(ranked) & 1) {
+            odd = ~odd;
+        }
+
+        if (pending != SIZE_MAX && ~c.ident) {
+            addIdentifier(pending, base + __builtin_ctzll(~c.ident));
+            pending = SIZE_MAX;
+        }
+        uint64_t starts =
+            identStart | c.binary | c.negation | c.lparen | c.rparen;
+        for (; starts; starts &= starts - 1) {
+            const unsigned i = __builtin_ctzll(starts);
+            if (!((identStart >> i) & 1)) {
+                tokens.push_back(
+                    Token(SYMBOL_TYPES.of[(unsigned char)block[i]]));
+                continue;
+            }
+            const uint64_t stop = ~c.ident >> i;
+            if (stop) {
+                addIdentifier(base + i, base + i + __builtin_ctzll(stop));
+            } else {
+                pending = base + i;
             }
+        }
+    }
+    if (pending != SIZE_MAX) {
+        addIdentifier(pending, size);
+    }
+    // the input must end with an operand, inside no parentheses
+    if (!odd || depth != 0) {
+        return false;
+    }
+    internIdentifiers(tokens);
+    return true;
+}
+
+TokenList Lexer::tokenizeScalar() {
+    TokenList tokens(memory);
+    // no token is shorter than a character, so this is enough for any input
+    // (pages of a large reservation that are never written are never
+    // mapped)
+    tokens.reserve(infix.size());
+
+    const char* begin = infix.data();
+    const char* end = begin + infix.size();
+    for (const char* p = begin; p < end; p++) {
+        if (diagnostics.size() >= MAX_DIAGNOSTICS) {
+            fail("too many errors, giving up", p - begin);
+            break;
+        }
+        char c = *p;
+        size_t offset = p - begin;
+        // the characters std::isspace accepts in the C locale
+        if (c == ' ' || (c >= '\t' && c <= '\r')) {
+            continue;
+        }
 
-            if (rank < 0) {
-                reportError("missing operand");
-                return std::vector<Token>{};
-            } else if (rank > 1) {
-                reportError("missing operator");
-                return std::vector<Token>{};
+        Token token = VariableToken(0);
+        switch (c) {
+        case '|':
+            token = OrToken();
+            break;
+        case '!':
+            token = NegationToken();
+            break;
+        case '&':
+            token = AndToken();
+            break;
+        case '^':
+            token = XorToken();
+            break;
+        case '>':
+            token = ImplicationToken();
+            break;
+        case '=':
+            token = BiconditionalToken();
+            break;
+        case '(':
+            token = LPARENToken();
+            break;
+        case ')':
+            if (bracketPositions.empty()) {
+                // no open bracket is set for this to close
+                fail("missing opening parentheses", offset);
+                continue;
+            }
+            token = RPARENToken();
+            break;
+        default: {
+            if (!isIdentifierChar(c)) {
+                fail("invalid character", offset);
+                continue;
+            }
+            const char* start = p;
+            while (p + 1 < end && isIdentifierChar(p[1])) {
+                p++;
+            }
+            if (!isIdentifierStart(c)) {
+                // a misspelt identifier still stands for an operand
+                fail("invalid character", offset);
+            } else {
+                token = VariableToken(0);
+                identifiers.emplace_back(start - begin, p + 1 - begin);
             }
+            break;
+        }
         }
 
-    next: {
-        try {
-            advance();
-        } catch (std::out_of_range) {
-            reachedEnd = true;
+        // After an error the scan carries on as if the input had been
+        // repaired with the least change: a missing operator or operand is
+        // assumed to be there, a stray operator or closing parenthesis is
+        // dropped.
+        if (rank == 1 && (token.isUnaryOperator() || token.isVariable() ||
+                          token.getTokenType() == TokenType::LPAREN)) {
+            // negations and opening parentheses start an operand
+            fail("missing operator", offset);
+            rank = 0;
+        } else if (rank == 0 && token.getTokenType() == TokenType::RPAREN) {
+            // closing parentheses end one
+            fail("missing operand", offset);
+            rank = 1;
         }
-    }
+
+        if (token.getTokenType() == TokenType::LPAREN) {
+            bracketPositions.push_back(offset);
+        } else if (token.getTokenType() == TokenType::RPAREN) {
+            bracketPositions.pop_back();
+        } else if (token.isVariable()) {
+            rank++;
+        } else if (!token.isUnaryOperator()) {
+            // a binary operator
+            if (rank == 0) {
+                fail("missing operand", offset);
+                continue;
+            }
+            rank--;
+        }
+        tokens.push_back(token);
     }
 
-    // rank checking is different here because the final value of an
-    // expression must be equal to one. the range of rank is [0, 1] inside
-    // loop.
+    // the final rank of an expression must be one, it stays in [0, 1]
+    // inside the loop
     if (rank < 1) {
-        reportError("missing operand");
-        return std::vector<Token>{};
-    } else if (rank > 1) {
-        reportError("missing operator");
-        return std::vector<Token>{};
+        fail("missing operand", infix.size());
+    }
+    for (size_t position : bracketPositions) {
+        fail("missing closing parentheses", position);
     }
 
-    if (!bracketPositions.empty()) {
-        reportError("missing closing parentheses", bracketPositions.top());
-        return std::vector<Token>{};
+    if (!diagnostics.empty()) {
+        std::stable_sort(diagnostics.begin(), diagnostics.end(),
+                         [](const Diagnostic& a, const Diagnostic& b) {
+                             return a.offset < b.offset;
+                         });
+        return TokenList(memory);
     }
+    internIdentifiers(tokens);
     return tokens;
 }
@@ -2,26 +2,73 @@
 #define LEXER_H
 
 #include "constants.hpp"
+#include "symbols.hpp"
 #include "tokens.hpp"
-#include <stack>
 #include <string>
+#include <string_view>
 #include <vector>
 
+// An error found in the input, at a byte offset into it.
+struct Diagnostic {
+    size_t offset;
+    std::string message;
+};
+
+// Splits an expression into tokens in a single pass, checking that
+// operators, operands and parentheses are balanced on the way. Errors are
+// collected as diagnostics instead of being printed or thrown, and the scan
+// recovers from each one so that a single pass finds all of them.
+//
+// Long inputs are classified 64 bytes at a time into bitmasks (see
+// charclass.hpp) and validated with bit operations on those masks. Invalid
+// ones are scanned again a character at a time to report the error.
 class Lexer {
 private:
-    const std::string& infix;
-    int position;
-    char currentChar;
+    std::string_view infix;
+    std::pmr::memory_resource* memory;
+    SymbolTable& names;
     int rank;
-    std::stack<int> bracketPositions;
+    std::pmr::vector<size_t> bracketPositions;
+    // the start and end of every identifier, in token order
+    std::pmr::vector<std::pair<size_t, size_t>> identifiers;
+    std::vector<Diagnostic> diagnostics;
 
-    void advance();
-    bool isVariable(char c);
-    void reportError(std::string error, int offset = -1);
+    bool isIdentifierStart(char c) const;
+    bool isIdentifierChar(char c) const;
+    void fail(std::string error, size_t offset);
+    void internIdentifiers(TokenList& tokens);
 
 public:
-    Lexer(const std::string& input);
-    std::vector<Token> tokenize();
+    // Inputs shorter than this are scanned a character at a time.
+    static const size_t BLOCK_BYTES = 256;
+    // Scanning stops after this many errors.
+    static const size_t MAX_DIAGNOSTICS = 100;
+    // Longer inputs are reported a window of this many bytes around each
+    // error at a time.
+    static const size_t DIAGNOSTIC_WIDTH = 160;
+
+    // The input must outlive the lexer. Tokens are allocated from `memory`
+    // and identifiers interned into `names`.
+    Lexer(std::string_view input,
+          std::pmr::memory_resource* memory = std::pmr::get_default_resource(),
+          SymbolTable& names = symbols());
+    // Returns the tokens of the input, or nothing when it is invalid.
+    // Identifiers are interned only once the whole input is known to be
+    // valid, so a rejected input adds no names to the table.
+    TokenList tokenize();
+
+    // The two passes tokenize() chooses between, for checking one against
+    // the other. The block pass returns false as soon as it finds the input
+    // invalid, without diagnostics, the scalar pass reports every error.
+    // Either one is run at most once on a lexer.
+    bool tokenizeBlocks(TokenList& tokens);
+    TokenList tokenizeScalar();
+
+    const std::vector<Diagnostic>& getDiagnostics() const {
+        return diagnostics;
+    }
+    // Prints the input with a caret under each error, sorted by offset.
+    void reportDiagnostics() const;
 };
 
 #endif // LEXER_H
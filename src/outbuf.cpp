@@ -0,0 +1,76 @@
+#include "outbuf.hpp"
+#include <cerrno>
+#include <algorithm>
+#include <climits>
+#include <stdexcept>
+#include <sys/uio.h>
+#include <unistd.h>
+
+OutputBuffer::OutputBuffer(int fd, size_t capacity)
+    : fd(fd), buffer(capacity) {}
+
+OutputBuffer::~OutputBuffer() {
+    try {
+        flush();
+    } catch (const std::runtime_error&) {
+        // nothing sensible left to do with a failing descriptor
+    }
+}
+
+void OutputBuffer::writeAll(const char* data, size_t size) {
+    while (size > 0) {
+        auto n = ::write(fd, data, size);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(std::string("write failed: ") +
+                                     std::strerror(errno));
+        }
+        data += n;
+        size -= n;
+        written += n;
+    }
+}
+
+void OutputBuffer::makeRoom(size_t size) {
+    if (fd == MEMORY) {
+        buffer.resize(std::max(2 * buffer.size(), used + size));
+    } else {
+        flush();
+    }
+}
+
+void OutputBuffer::flush() {
+    if (fd == MEMORY) {
+        return;
+    }
+    auto pending = used;
+    used = 0;
+    writeAll(buffer.data(), pending);
+}
+
+void OutputBuffer::writeVector(iovec* blocks, size_t count) {
+    flush();
+    while (count > 0) {
+        auto n = ::writev(fd, blocks, std::min<size_t>(count, IOV_MAX));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(std::string("write failed: ") +
+                                     std::strerror(errno));
+        }
+        written += n;
+        // skip what was written, the first block may be left partially
+        while (count > 0 && (size_t)n >= blocks->iov_len) {
+            n -= blocks->iov_len;
+            blocks++;
+            count--;
+        }
+        if (count > 0) {
+            blocks->iov_base = (char*)blocks->iov_base + n;
+            blocks->iov_len -= n;
+        }
+    }
+}
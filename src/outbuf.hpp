@@ -0,0 +1,76 @@
+#ifndef OUTBUF_H
+#define OUTBUF_H
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+
+struct iovec;
+
+// Large user-space output buffer written to a file descriptor with write(2),
+// bypassing iostreams. Throws std::runtime_error when a write fails. Without
+// a descriptor (MEMORY) the buffer grows instead and keeps everything
+// appended until it is cleared.
+class OutputBuffer {
+private:
+    int fd;
+    std::vector<char> buffer;
+    size_t used = 0;
+    size_t written = 0;
+
+public:
+    static const size_t DEFAULT_CAPACITY = 4 << 20;
+    static constexpr int MEMORY = -1;
+
+    OutputBuffer(int fd, size_t capacity = DEFAULT_CAPACITY);
+    ~OutputBuffer();
+
+    void append(const char* data, size_t size) {
+        if (used + size > buffer.size()) {
+            makeRoom(size);
+            if (used + size > buffer.size()) {
+                writeAll(data, size);
+                return;
+            }
+        }
+        std::memcpy(buffer.data() + used, data, size);
+        used += size;
+    }
+    void append(const std::string& s) { append(s.data(), s.size()); }
+    void put(char c) {
+        if (used == buffer.size()) {
+            makeRoom(1);
+        }
+        buffer[used++] = c;
+    }
+
+    // Room for `size` bytes, at most the capacity, at the end of the buffer.
+    // Whatever is filled in is kept by advance().
+    char* reserve(size_t size) {
+        if (used + size > buffer.size()) {
+            makeRoom(size);
+        }
+        return buffer.data() + used;
+    }
+    void advance(size_t size) { used += size; }
+
+    void flush();
+    size_t capacity() const { return buffer.size(); }
+    // Bytes handed to the buffer so far, flushed or not.
+    size_t bytesWritten() const { return written + used; }
+
+    // The bytes not flushed yet, everything appended for a MEMORY buffer.
+    const char* data() const { return buffer.data(); }
+    size_t size() const { return used; }
+    void clear() { used = 0; }
+
+    // Flushes the buffer, then writes `count` blocks with writev(2).
+    void writeVector(iovec* blocks, size_t count);
+
+private:
+    void makeRoom(size_t size);
+    void writeAll(const char* data, size_t size);
+};
+
+#endif // OUTBUF_H
@@ -0,0 +1,255 @@
+#include "pager.hpp"
+#include "outbuf.hpp"
+#include "rowwriter.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <stdexcept>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <vector>
+
+// Switches the terminal to the alternate screen with key echo and line
+// editing off for as long as it lives.
+class TerminalSession {
+private:
+    termios saved;
+    // bytes read but not yet returned as keys
+    std::string pending;
+
+public:
+    TerminalSession() {
+        if (!isatty(STDIN_FILENO) || !isatty(STDOUT_FILENO) ||
+            tcgetattr(STDIN_FILENO, &saved) != 0) {
+            throw std::runtime_error("the pager needs a terminal");
+        }
+        termios raw = saved;
+        // output processing stays on so that "\n" still returns the cursor
+        raw.c_lflag &= ~(ICANON | ECHO | ISIG | IEXTEN);
+        raw.c_iflag &= ~(IXON | ICRNL);
+        raw.c_cc[VMIN] = 1;
+        raw.c_cc[VTIME] = 0;
+        tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw);
+        // wide tables are cut at the edge of the screen instead of wrapping
+        write("\x1b[?1049h\x1b[?25l\x1b[?7l");
+    }
+    ~TerminalSession() {
+        write("\x1b[?7h\x1b[?25h\x1b[?1049l");
+        tcsetattr(STDIN_FILENO, TCSAFLUSH, &saved);
+    }
+
+    static void write(const std::string& s) {
+        ssize_t written = ::write(STDOUT_FILENO, s.data(), s.size());
+        (void)written;
+    }
+
+    // Reads the next key press, which may be an escape sequence. Returns an
+    // empty string when interrupted (the window was resized) and "q" at the
+    // end of input.
+    std::string readKey() {
+        if (pending.empty()) {
+            char buffer[64];
+            ssize_t n = ::read(STDIN_FILENO, buffer, sizeof(buffer));
+            if (n < 0 && errno == EINTR) {
+                return "";
+            }
+            if (n <= 0) {
+                return "q";
+            }
+            pending.assign(buffer, n);
+        }
+        // an escape sequence runs up to its final letter or '~'
+        size_t length = 1;
+        if (pending[0] == '\x1b' && pending.size() > 2 &&
+            (pending[1] == '[' || pending[1] == 'O')) {
+            length = 2;
+            while (length < pending.size() &&
+                   !std::isalpha((unsigned char)pending[length]) &&
+                   pending[length] != '~') {
+                length++;
+            }
+            length = std::min(length + 1, pending.size());
+        }
+        auto key = pending.substr(0, length);
+        pending.erase(0, length);
+        return key;
+    }
+};
+
+Pager::Pager(TruthTable& table)
+    : table(table),
+      renderer(table.getVariables(), table.getExpression(), true),
+      formatter(renderer.isValid() ? renderer.rowFormatter()
+                                   : RowFormatter({}, {})),
+      sim(table.newSimulator()) {
+    if (!renderer.isValid()) {
+        throw std::runtime_error("the table is too wide for the pager");
+    }
+    headerLines = std::count(renderer.getTop().begin(),
+                             renderer.getTop().end(), '\n');
+}
+
+void Pager::measure() {
+    winsize size;
+    size_t lines = 24;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_row > 0) {
+        lines = size.ws_row;
+        width = size.ws_col;
+    }
+    // the bottom border and the status line take two more lines
+    height = lines > headerLines + 3 ? lines - headerLines - 2 : 1;
+    height = std::min(height, table.rowCount());
+}
+
+void Pager::scrollTo(uint64_t row) {
+    top = std::min(row, table.rowCount() - height);
+}
+
+void Pager::draw() {
+    measure();
+    scrollTo(top);
+
+    OutputBuffer out(STDOUT_FILENO);
+    out.append("\x1b[H\x1b[2J");
+    out.append(renderer.getTop());
+
+    // only the words holding the visible rows are evaluated
+    appendRows(table, sim, formatter, top, top + height, out);
+    out.append(renderer.getBottom());
+
+    std::string status = " rows " + std::to_string(top) + "-" +
+                         std::to_string(top + height - 1) + " of " +
+                         std::to_string(table.rowCount());
+    if (!number.empty()) {
+        status += "  row: " + number;
+    } else if (!message.empty()) {
+        status += "  " + message;
+    } else {
+        status += "  j/k space/b g/G <row>g t/f T/F q";
+    }
+    status.resize(std::min(status.size(), width > 0 ? width - 1 : 0));
+    out.append("\x1b[7m" + status + "\x1b[0m");
+    out.flush();
+}
+
+// Moves to the nearest row after (or before) the first one on screen whose
+// result is `value`, scanning SEARCH_ROWS rows at most.
+void Pager::search(bool value, bool forward) {
+    const uint64_t rows = table.rowCount();
+    const uint64_t batch = TruthTable::BATCH_ROWS / 64;
+    const uint64_t flip = value ? 0 : ~0ull;
+    std::vector<uint64_t> words(batch);
+    auto found = [&](uint64_t row) {
+        scrollTo(row);
+        message = "row " + std::to_string(row) + " is " +
+                  (value ? "true" : "false");
+    };
+
+    uint64_t scanned = 0;
+    if (forward) {
+        uint64_t start = top + 1;
+        for (uint64_t w = start / 64; w * 64 < rows && scanned < SEARCH_ROWS;
+             w += batch, scanned += 64 * batch) {
+            size_t count = std::min(batch, table.wordCount() - w);
+            table.evaluate(w, count, words.data());
+            for (size_t i = 0; i < count; i++) {
+                uint64_t row = 64 * (w + i);
+                uint64_t bits = words[i] ^ flip;
+                if (rows - row < 64) {
+                    bits &= (1ull << (rows - row)) - 1;
+                }
+                if (row < start) {
+                    bits &= ~0ull << (start - row);
+                }
+                if (bits) {
+                    found(row + __builtin_ctzll(bits));
+                    return;
+                }
+            }
+        }
+    } else if (top > 0) {
+        uint64_t end = top - 1;
+        for (uint64_t w = end / 64 + 1; w > 0 && scanned < SEARCH_ROWS;
+             scanned += 64 * batch) {
+            size_t count = std::min(batch, w);
+            w -= count;
+            table.evaluate(w, count, words.data());
+            for (size_t i = count; i-- > 0;) {
+                uint64_t row = 64 * (w + i);
+                uint64_t bits = words[i] ^ flip;
+                if (rows - row < 64) {
+                    bits &= (1ull << (rows - row)) - 1;
+                }
+                if (end - row < 63) {
+                    bits &= (2ull << (end - row)) - 1;
+                }
+                if (bits) {
+                    found(row + 63 - __builtin_clzll(bits));
+                    return;
+                }
+            }
+        }
+    }
+    message = std::string("no ") + (value ? "true" : "false") + " result " +
+              (forward ? "below" : "above");
+    if (scanned >= SEARCH_ROWS) {
+        message += " within " + std::to_string(SEARCH_ROWS) + " rows";
+    }
+}
+
+bool Pager::handleKey(const std::string& key) {
+    message.clear();
+    if (key.size() == 1 && key[0] >= '0' && key[0] <= '9') {
+        if (number.size() < 18) {
+            number += key;
+        }
+        return true;
+    }
+    std::string typed;
+    std::swap(typed, number);
+
+    const uint64_t last = table.rowCount() - 1;
+    bool home = key == "g" || key == "\x1b[H" || key == "\x1b[1~" ||
+                key == "\x1bOH";
+    bool end = key == "G" || key == "\x1b[F" || key == "\x1b[4~" ||
+               key == "\x1bOF";
+    bool enter = key == "\r" || key == "\n";
+    if (key == "q" || key == "Q" || key == "\x1b" || key == "\x03") {
+        return false;
+    } else if (!typed.empty() && (home || end || enter)) {
+        uint64_t row = std::stoull(typed);
+        if (row > last) {
+            message = "row " + typed + " is out of range";
+        } else {
+            scrollTo(row);
+        }
+    } else if (home) {
+        scrollTo(0);
+    } else if (end) {
+        scrollTo(last);
+    } else if (enter || key == "j" || key == "\x1b[B" || key == "\x1bOB") {
+        scrollTo(top + 1);
+    } else if (key == "k" || key == "\x1b[A" || key == "\x1bOA") {
+        scrollTo(top > 0 ? top - 1 : 0);
+    } else if (key == " " || key == "\x1b[6~" || key == "\x06") {
+        scrollTo(top + height);
+    } else if (key == "b" || key == "\x1b[5~" || key == "\x02") {
+        scrollTo(top > height ? top - height : 0);
+    } else if (key == "t" || key == "f" || key == "T" || key == "F") {
+        search(key == "t" || key == "T", key == "t" || key == "f");
+    }
+    return true;
+}
+
+void Pager::run() {
+    TerminalSession session;
+    draw();
+    while (true) {
+        auto key = session.readKey();
+        if (!key.empty() && !handleKey(key)) {
+            break;
+        }
+        draw();
+    }
+}
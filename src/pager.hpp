@@ -0,0 +1,54 @@
+#ifndef PAGER_H
+#define PAGER_H
+
+#include "renderer.hpp"
+#include "rowformat.hpp"
+#include "simulator.hpp"
+#include "truthtable.hpp"
+#include <cstdint>
+#include <string>
+
+// Full screen pager over a truth table. Only the rows on screen are
+// evaluated and rendered, their variable values following from the row
+// indices, so tables of any size open at once and memory stays flat.
+//
+// Keys: j/k or the arrows move by a row, space/b or page down/up by a
+// screen, g/G or home/end go to the first and the last row, a row number
+// followed by g or enter jumps to it, and t/f (T/F) find the next
+// (previous) row whose result is true/false. q leaves.
+class Pager {
+private:
+    TruthTable& table;
+    TableRenderer renderer;
+    RowFormatter formatter;
+    Simulator sim;
+    size_t headerLines = 0;
+    // first row on screen and the number of rows that fit
+    uint64_t top = 0;
+    uint64_t height = 1;
+    size_t width = 80;
+    // digits typed before a key
+    std::string number;
+    std::string message;
+
+    void measure();
+    void scrollTo(uint64_t row);
+    void draw();
+    void search(bool value, bool forward);
+    // Handles a key press, returns false when it leaves the pager.
+    bool handleKey(const std::string& key);
+
+public:
+    // rows scanned by one search before giving up
+    static const uint64_t SEARCH_ROWS = 1ull << 32;
+
+    // Throws std::runtime_error when the table cannot be laid out from
+    // templates, see TableRenderer::isValid().
+    Pager(TruthTable& table);
+
+    // Takes over the terminal until the user quits. Throws
+    // std::runtime_error when stdin or stdout is not a terminal.
+    void run();
+};
+
+#endif // PAGER_H
@@ -0,0 +1,88 @@
+#include "parser.hpp"
+#include <stdexcept>
+
+// Twice the precedence, so that right associative operators can bind a
+// little less to their right than to their left.
+static int leftPower(TokenType type) {
+    return 2 * TOKEN_TRAITS[(int)type].precedence;
+}
+
+static int rightPower(TokenType type) {
+    auto& traits = TOKEN_TRAITS[(int)type];
+    return 2 * traits.precedence +
+           (traits.associativity == Associativity::LEFT ? 1 : -1);
+}
+
+static bool isBinary(TokenType type) {
+    return type != TokenType::VARIABLE && type != TokenType::NEGATION_OP &&
+           type != TokenType::LPAREN && type != TokenType::RPAREN;
+}
+
+Parser::Parser(const TokenList& tokens, std::pmr::memory_resource* memory,
+               const SymbolTable& names)
+    : tokens(tokens), memory(memory), names(names) {}
+
+Ast Parser::parse() {
+    // an operator or an opening parenthesis waiting for its (right)
+    // operand, and the power that operand binds with
+    struct Frame {
+        TokenType type;
+        uint32_t left;
+        int power;
+    };
+    std::pmr::vector<Frame> frames(memory);
+    Ast ast(memory, names);
+    ast.reserve(tokens.size());
+
+    const size_t n = tokens.size();
+    size_t pos = 0;
+    auto malformed = [] {
+        return std::runtime_error("malformed expression");
+    };
+    while (true) {
+        // an operand: prefix operators and opening parentheses, then a
+        // variable
+        while (pos < n && (tokens[pos].isUnaryOperator() ||
+                           tokens[pos].getTokenType() == TokenType::LPAREN)) {
+            auto type = tokens[pos++].getTokenType();
+            // anything binds inside parentheses
+            frames.push_back(
+                Frame{type, 0, type == TokenType::LPAREN ? 0 : leftPower(type)});
+        }
+        if (pos == n || !tokens[pos].isVariable()) {
+            throw malformed();
+        }
+        uint32_t node = ast.addVariable(tokens[pos++].getSymbol());
+
+        // either the next binary operator takes the operand, or the
+        // operators waiting for it do
+        while (true) {
+            const int power = frames.empty() ? 0 : frames.back().power;
+            if (pos < n && isBinary(tokens[pos].getTokenType()) &&
+                leftPower(tokens[pos].getTokenType()) > power) {
+                auto type = tokens[pos++].getTokenType();
+                frames.push_back(Frame{type, node, rightPower(type)});
+                break;
+            }
+            if (frames.empty()) {
+                if (pos != n) {
+                    throw malformed();
+                }
+                return ast;
+            }
+            Frame frame = frames.back();
+            frames.pop_back();
+            if (frame.type == TokenType::LPAREN) {
+                if (pos == n ||
+                    tokens[pos].getTokenType() != TokenType::RPAREN) {
+                    throw malformed();
+                }
+                pos++;
+            } else if (frame.type == TokenType::NEGATION_OP) {
+                node = ast.addNegation(node);
+            } else {
+                node = ast.addBinary(frame.type, frame.left, node);
+            }
+        }
+    }
+}
@@ -0,0 +1,33 @@
+#ifndef PARSER_H
+#define PARSER_H
+
+#include "ast.hpp"
+#include "tokens.hpp"
+#include <vector>
+
+// Builds the syntax tree of a token sequence in one pass with a Pratt
+// parser. Each binary operator binds with a power derived from its
+// precedence, a little less on its right when it is right associative, and
+// a negation binds tighter than any of them.
+//
+// The operators and parentheses waiting for their operands are kept on an
+// explicit stack rather than the call stack, so arbitrarily deep
+// expressions parse in time and memory linear in their length.
+class Parser {
+private:
+    const TokenList& tokens;
+    std::pmr::memory_resource* memory;
+    const SymbolTable& names;
+
+public:
+    // The tokens must have been validated by the lexer, which interned
+    // their names into `names`. The tree and the parser's own state are
+    // allocated from `memory`.
+    Parser(const TokenList& tokens,
+           std::pmr::memory_resource* memory = std::pmr::get_default_resource(),
+           const SymbolTable& names = symbols());
+    // Throws std::runtime_error on a malformed token sequence.
+    Ast parse();
+};
+
+#endif // PARSER_H
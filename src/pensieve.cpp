@@ -1,28 +1,21 @@
+#include "arena.hpp"
+#include "commands.hpp"
 #include "constants.hpp"
+#include "equivalence.hpp"
 #include "interpreter.hpp"
 #include "lexer.hpp"
 #include "linenoise.h"
 #include "stringutils.hpp"
+#include <cerrno>
 #include <iostream>
+#include <optional>
 #include <string.h>
+#include <unistd.h>
 #include <vector>
 
-template <typename T>
-bool compareVectors(const std::vector<T>& v1, const std::vector<T>& v2) {
-    if (v1.size() != v2.size()) {
-        return false;
-    }
-    for (size_t i = 0; i < v1.size(); i++) {
-        if (v1[i] != v2[i]) {
-            return false;
-        }
-    }
-    return true;
-}
-
 /* * LINENOISE CONFIG * */
 
-static const char* examples[] = {"/debug", "/q", "exit", "quit", NULL};
+static const char* examples[] = {"/debug", "/aiger", "/fraig", "/sat", "/export", "/page", "/summary", "/bench", "/save", "/compress", "/query", "/q", "exit", "quit", NULL};
 
 void completionHook(char const* prefix, linenoiseCompletions* lc) {
     size_t i;
@@ -35,6 +28,22 @@ void completionHook(char const* prefix, linenoiseCompletions* lc) {
 }
 
 int main(int argc, char const* argv[]) {
+    if (argc == 3 && strcmp(argv[1], "--check") == 0) {
+        return checkFile(argv[2]);
+    }
+    if (argc == 3 && strcmp(argv[1], "--file") == 0) {
+        return fileCommand(argv[2]);
+    }
+    if (argc == 2 && strcmp(argv[1], "--stress") == 0) {
+        return stressTest();
+    }
+    if (argc > 1) {
+        std::cerr << "usage: pensieve [--check <file> | --file <file> | "
+                     "--stress]"
+                  << std::endl;
+        return 2;
+    }
+
     linenoiseInstallWindowChangeHandler();
     linenoiseSetCompletionCallback(completionHook);
     linenoiseHistorySetMaxLen(1000);
@@ -45,73 +54,180 @@ int main(int argc, char const* argv[]) {
     std::cout << purple("exit OR quit OR /q to exit") << '\n';
 
     auto debug = false;
+    // tokens, syntax trees and evaluation state of the current line
+    Arena arena;
+    // linenoise reads piped input in pieces of at most 4096 bytes, whole
+    // lines of any length are read from pipes here instead
+    const bool interactive = isatty(STDIN_FILENO);
+    char* line = NULL;
+    size_t lineCapacity = 0;
+    std::string input;
     while (true) {
-        char* result = linenoise(cyan("pensieve > ").c_str());
-        if (result == NULL) {
-            continue;
-        }
-        if (*result == '\0') {
+        arena.reset();
+        if (interactive) {
+            errno = 0;
+            char* result = linenoise(cyan("pensieve > ").c_str());
+            if (result == NULL) {
+                // ctrl-c only abandons the line, the end of the input
+                // (ctrl-d) ends the session
+                if (errno == EAGAIN) {
+                    continue;
+                }
+                break;
+            }
+            input.assign(result);
             free(result);
+            if (!input.empty()) {
+                linenoiseHistoryAdd(input.c_str());
+            }
+        } else {
+            ssize_t length = getline(&line, &lineCapacity, stdin);
+            if (length < 0) {
+                break;
+            }
+            if (length > 0 && line[length - 1] == '\n') {
+                length--;
+            }
+            input.assign(line, length);
+        }
+        if (input.empty()) {
             break;
         }
 
-        linenoiseHistoryAdd(result);
-
-        std::string input(result);
-        // std::cout << cyan("pensieve > ");
-        // std::getline(std::cin, input);
         trim(input);
-        std::transform(input.begin(), input.end(), input.begin(),
-                       [](unsigned char c) { return std::tolower(c); });
 
         if (input == "") {
             continue;
         }
 
-        if (input == "quit" || input == "exit" || input == "/q") {
+        // commands are case insensitive but keep the case of their arguments
+        // (file names), expressions are lowercased entirely
+        auto command = input.substr(0, input.find(' '));
+        auto args = input.substr(command.size());
+        trim(args);
+        std::transform(command.begin(), command.end(), command.begin(),
+                       [](unsigned char c) { return std::tolower(c); });
+        if (command[0] != '/') {
+            std::transform(input.begin(), input.end(), input.begin(),
+                           [](unsigned char c) { return std::tolower(c); });
+        }
+
+        if (input == "quit" || input == "exit" || command == "/q") {
             std::cout << purple("bye") << std::endl;
             break;
         }
 
-        if (input == "/debug") {
+        if (command == "/debug") {
             debug = !debug;
             std::cout << purple("debug mode ")
                       << purple((debug) ? "enabled" : "disabled") << '\n';
             continue;
         }
 
-        auto expressions = split(input, ',');
-        std::vector<std::vector<bool>> results; // Remove size initialization
+        if (command == "/aiger") {
+            aigerCommand(args);
+            continue;
+        }
+
+        if (command == "/fraig") {
+            fraigCommand(args);
+            continue;
+        }
+
+        if (command == "/sat") {
+            satCommand(args);
+            continue;
+        }
 
-        for (auto& expr : expressions) {
-            trim(expr); // Add trim to remove whitespace from split expressions
-            auto lexer = Lexer(expr);
+        if (command == "/export") {
+            exportCommand(args);
+            continue;
+        }
+
+        if (command == "/page") {
+            pageCommand(args);
+            continue;
+        }
+
+        if (command == "/summary") {
+            summaryCommand(args);
+            continue;
+        }
+
+        if (command == "/bench") {
+            benchCommand(args);
+            continue;
+        }
+
+        if (command == "/save") {
+            saveCommand(args);
+            continue;
+        }
+
+        if (command == "/compress") {
+            compressCommand(args);
+            continue;
+        }
+
+        if (command == "/query") {
+            queryCommand(args);
+            continue;
+        }
+
+        // the expressions are lexed straight out of the input line
+        ListSplitter expressions(input);
+        std::vector<AigLit> results;
+        std::vector<std::string_view> labels;
+        // Only a list of expressions is checked for equivalence. Its
+        // checker lives for the line, so the checks among its expressions
+        // share cones and learnt clauses, and nothing is kept afterwards.
+        std::optional<EquivalenceChecker> checker;
+        size_t count = 0;
+        ListSplitter pieces(input);
+        for (std::string_view piece; pieces.next(piece);) {
+            count++;
+        }
+        if (count > 1) {
+            checker.emplace();
+        }
+
+        for (std::string_view expr; expressions.next(expr);) {
+            auto lexer = Lexer(expr, &arena);
             auto tokens = lexer.tokenize();
+            lexer.reportDiagnostics();
             if (tokens.size() == 0) {
                 // lexer encountered an error during tokenization, the
                 // expression is invalid
                 continue;
             }
 
-            auto interpreter = Interpreter(tokens);
+            auto interpreter = Interpreter(tokens, &arena);
             if (debug) {
                 std::cout << yellow("postfix:\t" + interpreter.getPostfix())
                           << "\n";
                 std::cout << yellow("variables:\t" + interpreter.getVariables())
                           << "\n";
+                std::cout << yellow("aig:\t\t" + interpreter.getAIGSummary())
+                          << "\n";
             }
 
-            auto result = interpreter.evaluate();
-            results.push_back(result);
+            interpreter.evaluate();
+            if (checker) {
+                results.push_back(checker->add(interpreter));
+                labels.push_back(expr);
+            }
         }
 
         if (results.size() > 1) {
             bool same = true;
-            const auto& firstResult = results[0];
+            std::vector<std::pair<std::string, bool>> counterexample;
+            size_t differing = 0;
 
             for (size_t i = 1; i < results.size(); i++) {
-                if (!compareVectors(results[i], firstResult)) {
+                if (!checker->equivalent(results[0], results[i],
+                                         counterexample)) {
                     same = false;
+                    differing = i;
                     break;
                 }
             }
@@ -124,10 +240,30 @@ int main(int argc, char const* argv[]) {
                 std::cout
                     << red("All these expressions are NOT logically equivalent")
                     << std::endl;
+                std::string values;
+                for (auto& [name, value] : counterexample) {
+                    values += " " + name + "=" + (value ? "true" : "false");
+                }
+                std::cout << yellow("`" + std::string(labels[differing]) +
+                                    "` differs from `" +
+                                    std::string(labels[0]) + "` for" + values)
+                          << std::endl;
+            }
+
+            if (debug) {
+                const auto& stats = checker->getStats();
+                std::cout << yellow("sat:\t\t" + std::to_string(stats.solves) +
+                                    " solver calls, " +
+                                    std::to_string(stats.conflicts) +
+                                    " conflicts, " +
+                                    std::to_string(stats.learnts) +
+                                    " clauses learnt")
+                          << std::endl;
             }
         }
     }
 
+    free(line);
     linenoiseHistorySave(histFile);
     linenoiseHistoryFree();
 
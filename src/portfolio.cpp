@@ -0,0 +1,90 @@
+#include "portfolio.hpp"
+#include "cnf.hpp"
+#include "exchange.hpp"
+#include <atomic>
+#include <sstream>
+#include <thread>
+
+// Configurations handed out in order; past the end they repeat with other
+// seeds.
+static SolverOptions presetOptions(size_t i) {
+    static const SolverOptions presets[] = {
+        {RestartPolicy::LUBY, PhasePolicy::SAVED, 0, 0},
+        {RestartPolicy::GLUCOSE, PhasePolicy::SAVED, 0, 0},
+        {RestartPolicy::GEOMETRIC, PhasePolicy::ALWAYS_FALSE, 0, 0},
+        {RestartPolicy::LUBY, PhasePolicy::ALWAYS_TRUE, 0, 0.01},
+        {RestartPolicy::GLUCOSE, PhasePolicy::RANDOM, 0, 0.02},
+        {RestartPolicy::GEOMETRIC, PhasePolicy::SAVED, 0, 0.05},
+        {RestartPolicy::GLUCOSE, PhasePolicy::ALWAYS_FALSE, 0, 0.01},
+        {RestartPolicy::LUBY, PhasePolicy::RANDOM, 0, 0},
+    };
+    const size_t count = sizeof(presets) / sizeof(presets[0]);
+    auto options = presets[i % count];
+    options.seed = i;
+    return options;
+}
+
+std::string describeOptions(const SolverOptions& options) {
+    static const char* restarts[] = {"luby", "geometric", "glucose"};
+    static const char* phases[] = {"saved", "false", "true", "random"};
+    std::stringstream ss;
+    ss << restarts[(int)options.restarts] << " restarts, "
+       << phases[(int)options.phase] << " phase, seed " << options.seed;
+    if (options.randomDecisions > 0) {
+        ss << ", " << options.randomDecisions * 100 << "% random decisions";
+    }
+    return ss.str();
+}
+
+PortfolioResult solvePortfolio(const AIG& aig, AigLit root, size_t solvers) {
+    PortfolioResult portfolio;
+    solvers = std::max<size_t>(solvers, 1);
+    portfolio.stats.resize(solvers);
+    for (size_t i = 0; i < solvers; i++) {
+        portfolio.options.push_back(presetOptions(i));
+    }
+
+    ClauseExchange exchange;
+    std::atomic<bool> done{false};
+
+    // every thread encodes the AIG the same way, so variable numbers agree
+    // and shared clauses mean the same thing to every solver
+    auto run = [&](size_t id) {
+        Solver solver(portfolio.options[id]);
+        solver.setInterrupt(&done);
+        solver.setExchange(&exchange, id);
+        CnfEncoder encoder(aig, solver);
+        solver.addClause({encoder.literal(root)});
+        auto result = solver.solve();
+
+        bool expected = false;
+        if (result != SatResult::UNKNOWN &&
+            done.compare_exchange_strong(expected, true)) {
+            portfolio.result = result;
+            portfolio.winner = id;
+            if (result == SatResult::SATISFIABLE) {
+                portfolio.inputValues.assign(aig.inputCount(), false);
+                for (size_t i = 0; i < aig.inputCount(); i++) {
+                    auto node = aig.inputNode(i);
+                    if (encoder.isEncoded(node)) {
+                        portfolio.inputValues[i] = solver.modelValue(
+                            satMakeLit(encoder.nodeVar(node)));
+                    }
+                }
+            }
+        }
+        portfolio.stats[id] = solver.getStats();
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < solvers; i++) {
+        threads.emplace_back(run, i);
+    }
+    run(0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    portfolio.sharedClauses = exchange.published();
+    return portfolio;
+}
@@ -0,0 +1,27 @@
+#ifndef PORTFOLIO_H
+#define PORTFOLIO_H
+
+#include "aig.hpp"
+#include "solver.hpp"
+#include <string>
+#include <vector>
+
+struct PortfolioResult {
+    SatResult result = SatResult::UNKNOWN;
+    // values of the AIG inputs in the winner's satisfying assignment
+    std::vector<bool> inputValues;
+    size_t winner = 0;
+    uint64_t sharedClauses = 0;
+    std::vector<SolverOptions> options;
+    std::vector<SolverStats> stats;
+};
+
+// Decides whether `root` can be true by running `solvers` differently
+// configured solver instances in parallel threads on the same encoding.
+// They share short learnt clauses through a lock-free exchange, and the
+// first one to finish stops all the others.
+PortfolioResult solvePortfolio(const AIG& aig, AigLit root, size_t solvers);
+
+std::string describeOptions(const SolverOptions& options);
+
+#endif // PORTFOLIO_H
@@ -0,0 +1,168 @@
+#include "renderer.hpp"
+#include "rowwriter.hpp"
+#include <algorithm>
+#include <atomic>
+#include <sstream>
+
+tabulate::Table makeTruthTable(const std::vector<std::string>& variables,
+                               const std::string& expression,
+                               const std::vector<std::vector<bool>>& rows) {
+    tabulate::Table truthTable;
+
+    // Add header row with variable names
+    auto headerRow = tabulate::RowStream{};
+    for (const auto& name : variables) {
+        headerRow << name;
+    }
+    headerRow << expression;
+    truthTable.add_row(headerRow);
+
+    // Format header row
+    truthTable.row(0)
+        .format()
+        .font_style({tabulate::FontStyle::bold})
+        .font_align(tabulate::FontAlign::center);
+
+    // Add data rows
+    for (auto& row : rows) {
+        auto dataRow = tabulate::RowStream{};
+        for (bool value : row) {
+            dataRow << (value ? "true" : "false");
+        }
+        truthTable.add_row(dataRow);
+    }
+
+    // Apply cell-level formatting
+    // Format column headers
+    for (size_t i = 0; i < variables.size(); i++) {
+        truthTable[0][i].format().font_color(tabulate::Color::blue);
+    }
+    // Format the expression header
+    truthTable[0][variables.size()].format().font_color(
+        tabulate::Color::magenta);
+
+    // Format data cells
+    for (size_t rowIdx = 0; rowIdx < rows.size(); rowIdx++) {
+        // Format variable columns
+        for (size_t colIdx = 0; colIdx < variables.size(); colIdx++) {
+            bool cellValue = rows[rowIdx][colIdx];
+            truthTable[rowIdx + 1][colIdx]
+                .format()
+                .font_align(tabulate::FontAlign::center)
+                .font_color(cellValue ? tabulate::Color::green
+                                      : tabulate::Color::red);
+        }
+
+        // Format result column
+        bool resultValue = rows[rowIdx][variables.size()];
+        truthTable[rowIdx + 1][variables.size()]
+            .format()
+            .font_align(tabulate::FontAlign::center)
+            .font_color(resultValue ? tabulate::Color::green
+                                    : tabulate::Color::red)
+            .font_style({tabulate::FontStyle::bold});
+    }
+
+    return truthTable;
+}
+
+// Splits a single line data row at its column separators into the text
+// before the first one, each cell and the text after the last one.
+static bool splitRow(const std::string& line, size_t columns,
+                     std::vector<std::string>& pieces) {
+    pieces.clear();
+    size_t start = 0;
+    while (true) {
+        size_t bar = line.find('|', start);
+        pieces.push_back(line.substr(start, bar - start));
+        if (bar == std::string::npos) {
+            break;
+        }
+        start = bar + 1;
+    }
+    return pieces.size() == columns + 2 && pieces.front().empty();
+}
+
+TableRenderer::TableRenderer(const std::vector<std::string>& variables,
+                             const std::string& expression, bool colour) {
+    const size_t columns = variables.size() + 1;
+    auto sample = makeTruthTable(
+        variables, expression,
+        {std::vector<bool>(columns, true), std::vector<bool>(columns, false)});
+    std::stringstream ss;
+    if (colour) {
+        // termcolor's colour flag index is a static in a header, one per
+        // translation unit, and whichever copy of its inline functions the
+        // linker keeps decides which index is read. Setting every index
+        // allocated so far on this private stream covers all of them.
+        for (int i = 0, end = std::ios_base::xalloc(); i < end; i++) {
+            ss.iword(i) = 1;
+        }
+    }
+    ss << sample;
+
+    // borders start with '+', the header may span several lines
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(ss, line);) {
+        lines.push_back(line);
+    }
+    std::vector<size_t> borders;
+    for (size_t i = 0; i < lines.size(); i++) {
+        if (!lines[i].empty() && lines[i][0] == '+') {
+            borders.push_back(i);
+        }
+    }
+    size_t n = lines.size();
+    if (borders.size() != 4 || borders[0] != 0 || borders[1] + 4 != n - 1 ||
+        borders[2] != n - 3 || borders[3] != n - 1) {
+        return;
+    }
+
+    std::vector<std::string> truePieces, falsePieces;
+    if (!splitRow(lines[n - 4], columns, truePieces) ||
+        !splitRow(lines[n - 2], columns, falsePieces) ||
+        truePieces.back() != falsePieces.back()) {
+        return;
+    }
+    for (size_t c = 0; c < columns; c++) {
+        trueCells.push_back("|" + truePieces[c + 1]);
+        falseCells.push_back("|" + falsePieces[c + 1]);
+    }
+    rowEnd = "|" + truePieces.back() + "\n";
+    for (size_t i = 0; i < borders[1]; i++) {
+        top += lines[i] + "\n";
+    }
+    top += lines[borders[1]] + "\n";
+    separator = lines[n - 3] + "\n";
+    bottom = lines[n - 1] + "\n";
+    valid = true;
+}
+
+RowFormatter TableRenderer::rowFormatter() const {
+    // the row end rides on the result cell
+    std::vector<std::string> rowTrueCells(trueCells), rowFalseCells(falseCells);
+    rowTrueCells.back() += rowEnd;
+    rowFalseCells.back() += rowEnd;
+    return RowFormatter(rowTrueCells, rowFalseCells);
+}
+
+uint64_t TableRenderer::render(TruthTable& table, OutputBuffer& out) {
+    return renderRows(table, 0, table.rowCount(), true, out);
+}
+
+uint64_t TableRenderer::renderRows(TruthTable& table, uint64_t first,
+                                   uint64_t last, bool header,
+                                   OutputBuffer& out) {
+    out.append(header ? top : separator);
+    // every row is followed by a border, the bottom one for the last row
+    auto formatter = rowFormatter();
+    std::atomic<uint64_t> trueRows(0);
+    writeRows(
+        table, first, last,
+        [&](Simulator& sim, uint64_t from, uint64_t to, OutputBuffer& buffer) {
+            trueRows += appendRows(table, sim, formatter, from, to, buffer,
+                                   separator, last - 1, bottom);
+        },
+        out);
+    return trueRows;
+}
@@ -0,0 +1,64 @@
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include "outbuf.hpp"
+#include "rowformat.hpp"
+#include "tabulate.hpp"
+#include "truthtable.hpp"
+#include <string>
+#include <vector>
+
+// Builds the tabulate table pensieve prints for a truth table: the variables
+// and the expression as a bold header, then one row per entry of `rows`
+// (the variable values followed by the result) with green and red cells.
+tabulate::Table makeTruthTable(const std::vector<std::string>& variables,
+                               const std::string& expression,
+                               const std::vector<std::vector<bool>>& rows);
+
+// Prints large truth tables row by row with the same bytes tabulate would
+// produce, without building a cell (and a Format) per value. tabulate itself
+// renders a three row table once, the header plus an all true and an all
+// false row, and the borders, the header and every cell are cut out of it
+// as templates. Rows are then assembled from those templates straight into
+// an output buffer.
+class TableRenderer {
+private:
+    bool valid = false;
+    std::string top;
+    std::string separator;
+    std::string bottom;
+    std::vector<std::string> trueCells;
+    std::vector<std::string> falseCells;
+    std::string rowEnd;
+
+public:
+    // Tables of up to this many rows are still printed by tabulate.
+    static const uint64_t TABULATE_ROWS = 1024;
+
+    // `colour` asks for the escape codes tabulate writes to a terminal.
+    TableRenderer(const std::vector<std::string>& variables,
+                  const std::string& expression, bool colour);
+
+    // False when tabulate laid the table out in a way the templates cannot
+    // reproduce (cells wrapped over several lines), so it should print the
+    // table itself.
+    bool isValid() const { return valid; }
+
+    // Prints the whole table, which must have the columns given to the
+    // constructor, and returns the number of true rows.
+    uint64_t render(TruthTable& table, OutputBuffer& out);
+    // Prints rows [first, last) as a table of their own, under the header
+    // when `header` is set and under a plain border otherwise, and returns
+    // the number of true rows among them.
+    uint64_t renderRows(TruthTable& table, uint64_t first, uint64_t last,
+                        bool header, OutputBuffer& out);
+
+    // The header with the borders around it, and the border below the last
+    // row.
+    const std::string& getTop() const { return top; }
+    const std::string& getBottom() const { return bottom; }
+    // Writes the line of a row, the variables followed by the result.
+    RowFormatter rowFormatter() const;
+};
+
+#endif // RENDERER_H
@@ -0,0 +1,63 @@
+#include "rowformat.hpp"
+#include "transpose.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+RowFormatter::RowFormatter(const std::vector<std::string>& trueCells,
+                           const std::vector<std::string>& falseCells)
+    : columns(trueCells.size()) {
+    if (columns > MAX_COLUMNS) {
+        throw std::runtime_error("too many columns to format");
+    }
+    for (size_t first = 0; first < columns; first += 8) {
+        size_t last = std::min(columns, first + 8);
+        // combinations setting columns past the last one never occur
+        std::vector<std::string> combinations(1 << (last - first));
+        size_t longest = 0;
+        for (size_t bits = 0; bits < combinations.size(); bits++) {
+            for (size_t c = first; c < last; c++) {
+                combinations[bits] +=
+                    (bits >> (c - first)) & 1 ? trueCells[c] : falseCells[c];
+            }
+            longest = std::max(longest, combinations[bits].size());
+        }
+
+        Group g{text.size(), (longest + 15) / 16 * 16};
+        text.resize(text.size() + 256 * g.stride);
+        for (size_t bits = 0; bits < 256; bits++) {
+            if (bits < combinations.size()) {
+                auto& s = combinations[bits];
+                std::memcpy(&text[g.offset + bits * g.stride], s.data(),
+                            s.size());
+                lengths.push_back(s.size());
+            } else {
+                lengths.push_back(0);
+            }
+        }
+        groups.push_back(g);
+        rowBytes += g.stride;
+    }
+}
+
+void RowFormatter::transpose(const uint64_t* columnWords,
+                             uint64_t* rowWords) const {
+    if (columns > 8) {
+        for (size_t c = 0; c < 64; c++) {
+            rowWords[c] = c < columns ? columnWords[c] : 0;
+        }
+        transpose64x64(rowWords);
+        return;
+    }
+    // Narrow tables need a single byte per row: byte b of every column
+    // forms an 8x8 block of rows 8b to 8b + 7.
+    for (size_t b = 0; b < 8; b++) {
+        uint64_t block = 0;
+        for (size_t c = 0; c < columns; c++) {
+            block |= ((columnWords[c] >> (8 * b)) & 255) << (8 * c);
+        }
+        block = transpose8x8(block);
+        for (size_t r = 0; r < 8; r++) {
+            rowWords[8 * b + r] = (block >> (8 * r)) & 255;
+        }
+    }
+}
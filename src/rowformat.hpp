@@ -0,0 +1,73 @@
+#ifndef ROWFORMAT_H
+#define ROWFORMAT_H
+
+#include "outbuf.hpp"
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Writes rows of true/false cells given as packed columns, one word of 64
+// rows per column. A block of rows is first transposed into one word per
+// row, bit c holding column c, so that writing a row reads one word instead
+// of gathering a bit from every column. The row is then written eight
+// columns at a time from the texts of all 256 combinations of each group of
+// eight cells.
+class RowFormatter {
+private:
+    // Combination b of group g is at text[offsets[g] + b * strides[g]], each
+    // stride a multiple of 16 so that texts are copied in whole chunks.
+    struct Group {
+        size_t offset;
+        size_t stride;
+    };
+
+    size_t columns;
+    std::vector<Group> groups;
+    std::vector<char> text;
+    std::vector<uint32_t> lengths;
+    // the room a row needs including the bytes copied past its end
+    size_t rowBytes = 0;
+
+public:
+    static const size_t MAX_COLUMNS = 64;
+
+    // The text of each column's cell when it is true and when it is false.
+    // Throws std::runtime_error for more than MAX_COLUMNS columns.
+    RowFormatter(const std::vector<std::string>& trueCells,
+                 const std::vector<std::string>& falseCells);
+
+    size_t columnCount() const { return columns; }
+
+    // Transposes a block of 64 rows, word c of `columnWords` holding column
+    // c, into `rowWords`, word r holding row r.
+    void transpose(const uint64_t* columnWords, uint64_t* rowWords) const;
+
+    void appendRow(uint64_t row, OutputBuffer& out) const {
+        const uint32_t* length = lengths.data();
+        if (rowBytes > out.capacity()) {
+            for (auto& g : groups) {
+                size_t b = row & 255;
+                out.append(&text[g.offset + b * g.stride], length[b]);
+                row >>= 8;
+                length += 256;
+            }
+            return;
+        }
+        char* start = out.reserve(rowBytes);
+        char* p = start;
+        for (auto& g : groups) {
+            size_t b = row & 255;
+            const char* src = &text[g.offset + b * g.stride];
+            for (size_t k = 0; k < g.stride; k += 16) {
+                std::memcpy(p + k, src + k, 16);
+            }
+            p += length[b];
+            row >>= 8;
+            length += 256;
+        }
+        out.advance(p - start);
+    }
+};
+
+#endif // ROWFORMAT_H
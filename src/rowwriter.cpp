@@ -0,0 +1,179 @@
+#include "rowwriter.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <sys/uio.h>
+#include <thread>
+#include <vector>
+
+// rows per chunk, a multiple of 64 so that chunks never share a word
+static const uint64_t CHUNK_ROWS = 1 << 14;
+// smaller ranges are formatted on the calling thread
+static const uint64_t PARALLEL_ROWS = 4 * CHUNK_ROWS;
+// chunks in flight per worker, bounding the memory held by buffers
+static const size_t CHUNKS_PER_WORKER = 2;
+
+uint64_t appendRows(const TruthTable& table, Simulator& sim,
+                const RowFormatter& formatter, uint64_t first, uint64_t last,
+                OutputBuffer& out, const std::string& separator,
+                uint64_t closingRow, const std::string& closing) {
+    const size_t n = table.variableCount();
+    const bool borders = !separator.empty() || !closing.empty();
+    std::vector<uint64_t> words(TruthTable::BATCH_ROWS / 64);
+    std::vector<uint64_t> columns(n + 1);
+    uint64_t rowWords[64];
+    uint64_t trueRows = 0;
+    for (uint64_t batch = first / 64 * 64; batch < last;
+         batch += TruthTable::BATCH_ROWS) {
+        uint64_t end = std::min(last, batch + TruthTable::BATCH_ROWS);
+        table.evaluate(sim, batch / 64, (end - batch + 63) / 64, words.data());
+        for (uint64_t block = batch; block < end; block += 64) {
+            TruthTable::variableWords(n, block / 64, columns.data());
+            columns[n] = words[(block - batch) / 64];
+            formatter.transpose(columns.data(), rowWords);
+            uint64_t from = std::max(first, block);
+            uint64_t to = std::min(end, block + 64);
+            // only the bits of rows [from, to) are counted
+            uint64_t mask = to - from == 64
+                                ? ~0ull
+                                : ((1ull << (to - from)) - 1) << (from - block);
+            trueRows += __builtin_popcountll(columns[n] & mask);
+            for (uint64_t row = from; row < to; row++) {
+                formatter.appendRow(rowWords[row - block], out);
+                if (borders) {
+                    out.append(row == closingRow ? closing : separator);
+                }
+            }
+        }
+    }
+    return trueRows;
+}
+
+// Chunk c is formatted into slot c % slots.size(), which is free again once
+// chunk c - slots.size() has been written.
+struct ChunkQueue {
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<OutputBuffer> slots;
+    std::vector<bool> ready;
+    size_t next = 0;
+    size_t written = 0;
+    size_t chunks = 0;
+    bool stop = false;
+    std::exception_ptr error;
+};
+
+void writeRows(TruthTable& table, uint64_t first, uint64_t last,
+               const RowRangeFormatter& format, OutputBuffer& out) {
+    size_t workers = std::thread::hardware_concurrency();
+    if (last - first < PARALLEL_ROWS || workers < 2) {
+        Simulator sim = table.newSimulator();
+        format(sim, first, last, out);
+        return;
+    }
+
+    // chunk boundaries fall on multiples of CHUNK_ROWS
+    auto chunkFirst = [&](size_t c) {
+        return c == 0 ? first : (first / CHUNK_ROWS + c) * CHUNK_ROWS;
+    };
+    ChunkQueue queue;
+    queue.chunks = (last - 1) / CHUNK_ROWS - first / CHUNK_ROWS + 1;
+    workers = std::min<size_t>(workers, queue.chunks);
+    queue.slots.reserve(workers * CHUNKS_PER_WORKER);
+    for (size_t i = 0; i < workers * CHUNKS_PER_WORKER; i++) {
+        queue.slots.emplace_back(OutputBuffer::MEMORY, 1 << 20);
+    }
+    queue.ready.assign(queue.slots.size(), false);
+
+    auto work = [&]() {
+        Simulator sim = table.newSimulator();
+        while (true) {
+            size_t c;
+            {
+                std::unique_lock<std::mutex> lock(queue.mutex);
+                queue.changed.wait(lock, [&] {
+                    return queue.stop || queue.next >= queue.chunks ||
+                           queue.next < queue.written + queue.slots.size();
+                });
+                if (queue.stop || queue.next >= queue.chunks) {
+                    return;
+                }
+                c = queue.next++;
+            }
+            auto& buffer = queue.slots[c % queue.slots.size()];
+            try {
+                buffer.clear();
+                format(sim, chunkFirst(c), std::min(last, chunkFirst(c + 1)),
+                       buffer);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                if (!queue.error) {
+                    queue.error = std::current_exception();
+                }
+                queue.stop = true;
+                queue.changed.notify_all();
+                return;
+            }
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.ready[c % queue.slots.size()] = true;
+            queue.changed.notify_all();
+        }
+    };
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < workers; i++) {
+        threads.emplace_back(work);
+    }
+
+    // the calling thread writes every run of consecutive finished chunks
+    // with one writev
+    std::vector<iovec> blocks;
+    try {
+        while (true) {
+            size_t from, to;
+            {
+                std::unique_lock<std::mutex> lock(queue.mutex);
+                queue.changed.wait(lock, [&] {
+                    return queue.stop || queue.written >= queue.chunks ||
+                           queue.ready[queue.written % queue.slots.size()];
+                });
+                if (queue.stop || queue.written >= queue.chunks) {
+                    break;
+                }
+                from = queue.written;
+                to = from;
+                while (to < queue.chunks && to < from + queue.slots.size() &&
+                       queue.ready[to % queue.slots.size()]) {
+                    to++;
+                }
+            }
+            blocks.clear();
+            for (size_t c = from; c < to; c++) {
+                auto& buffer = queue.slots[c % queue.slots.size()];
+                blocks.push_back({const_cast<char*>(buffer.data()),
+                                  buffer.size()});
+            }
+            out.writeVector(blocks.data(), blocks.size());
+
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            for (size_t c = from; c < to; c++) {
+                queue.ready[c % queue.slots.size()] = false;
+            }
+            queue.written = to;
+            queue.changed.notify_all();
+        }
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.error) {
+            queue.error = std::current_exception();
+        }
+        queue.stop = true;
+        queue.changed.notify_all();
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (queue.error) {
+        std::rethrow_exception(queue.error);
+    }
+}
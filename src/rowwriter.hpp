@@ -0,0 +1,34 @@
+#ifndef ROWWRITER_H
+#define ROWWRITER_H
+
+#include "outbuf.hpp"
+#include "rowformat.hpp"
+#include "simulator.hpp"
+#include "truthtable.hpp"
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// Formats rows [first, last) of a table into a buffer, evaluating them with
+// the given simulator.
+using RowRangeFormatter = std::function<void(
+    Simulator& sim, uint64_t first, uint64_t last, OutputBuffer& out)>;
+
+// Writes rows [first, last) of a table through `format`. Large ranges are
+// cut into chunks that worker threads format into buffers of their own,
+// each evaluating its rows with its own simulator, and the buffers are
+// written with writev(2) in row order as soon as every chunk before them is
+// out, so the output is the same as when formatting on one thread.
+void writeRows(TruthTable& table, uint64_t first, uint64_t last,
+               const RowRangeFormatter& format, OutputBuffer& out);
+
+// The usual RowRangeFormatter body: evaluates rows [first, last) 64 at a
+// time, transposes each block and appends its rows through `formatter`.
+// Every row is followed by `separator`, except row `closingRow`, which is
+// followed by `closing`. Returns the number of true rows in the range.
+uint64_t appendRows(const TruthTable& table, Simulator& sim,
+                const RowFormatter& formatter, uint64_t first, uint64_t last,
+                OutputBuffer& out, const std::string& separator = "",
+                uint64_t closingRow = 0, const std::string& closing = "");
+
+#endif // ROWWRITER_H
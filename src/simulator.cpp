@@ -0,0 +1,67 @@
+#include "simulator.hpp"
+
+// The common 64 and 256 pattern widths get a fixed word count (W) so the
+// inner loop is fully unrolled and vectorized; W == 0 uses `words` instead.
+template <size_t W>
+static void simulateNodes(const std::vector<AigNode>& nodes, uint64_t* values,
+                          size_t words, uint32_t fromNode) {
+    const size_t n = W ? W : words;
+    for (size_t idx = fromNode; idx < nodes.size(); idx++) {
+        const auto& node = nodes[idx];
+        if (node.fanin0 == AIG_INPUT_MARK) {
+            continue;
+        }
+        const uint64_t* a = values + aigNode(node.fanin0) * n;
+        const uint64_t* b = values + aigNode(node.fanin1) * n;
+        uint64_t maskA = aigIsComplemented(node.fanin0) ? ~0ull : 0;
+        uint64_t maskB = aigIsComplemented(node.fanin1) ? ~0ull : 0;
+        uint64_t* out = values + idx * n;
+        for (size_t w = 0; w < n; w++) {
+            out[w] = (a[w] ^ maskA) & (b[w] ^ maskB);
+        }
+    }
+}
+
+Simulator::Simulator(const AIG& aig, size_t words)
+    : aig(aig), words(words), values(aig.nodeCount() * words, 0) {}
+
+uint64_t* Simulator::inputWords(size_t input) {
+    if (values.size() < aig.nodeCount() * words) {
+        values.resize(aig.nodeCount() * words, 0);
+    }
+    return values.data() + aig.inputNode(input) * words;
+}
+
+void Simulator::randomizeInputs(std::mt19937_64& rng) {
+    for (size_t i = 0; i < aig.inputCount(); i++) {
+        auto in = inputWords(i);
+        for (size_t w = 0; w < words; w++) {
+            in[w] = rng();
+        }
+    }
+}
+
+void Simulator::run(uint32_t fromNode) {
+    if (values.size() < aig.nodeCount() * words) {
+        values.resize(aig.nodeCount() * words, 0);
+    }
+    const auto& nodes = aig.getNodes();
+    switch (words) {
+    case 1:
+        simulateNodes<1>(nodes, values.data(), words, fromNode);
+        break;
+    case 4:
+        simulateNodes<4>(nodes, values.data(), words, fromNode);
+        break;
+    default:
+        simulateNodes<0>(nodes, values.data(), words, fromNode);
+    }
+}
+
+size_t Simulator::countOnes(AigLit lit) const {
+    size_t ones = 0;
+    for (size_t w = 0; w < words; w++) {
+        ones += __builtin_popcountll(literalWord(lit, w));
+    }
+    return ones;
+}
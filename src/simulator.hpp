@@ -0,0 +1,39 @@
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include "aig.hpp"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Bit-parallel AIG simulation. Every node holds `words` 64 bit words, each
+// bit being one input pattern, so a single pass over the node array
+// evaluates 64 * words patterns at once.
+class Simulator {
+private:
+    const AIG& aig;
+    size_t words;
+    std::vector<uint64_t> values;
+
+public:
+    Simulator(const AIG& aig, size_t words);
+
+    size_t getWords() const { return words; }
+    size_t patternCount() const { return 64 * words; }
+
+    uint64_t* inputWords(size_t input);
+    void randomizeInputs(std::mt19937_64& rng);
+    // Simulates every AND node from `fromNode` onwards. Nodes added to the
+    // AIG since the last run are picked up automatically.
+    void run(uint32_t fromNode = 1);
+
+    const uint64_t* nodeWords(uint32_t node) const {
+        return values.data() + node * words;
+    }
+    uint64_t literalWord(AigLit lit, size_t w) const {
+        return nodeWords(aigNode(lit))[w] ^ (aigIsComplemented(lit) ? ~0ull : 0);
+    }
+    size_t countOnes(AigLit lit) const;
+};
+
+#endif // SIMULATOR_H
@@ -0,0 +1,626 @@
+#include "solver.hpp"
+#include "exchange.hpp"
+#include <algorithm>
+#include <cmath>
+
+// number of recent LBDs averaged by glucose style restarts
+static const size_t RECENT_LBDS = 50;
+
+// Luby restart sequence: 1 1 2 1 1 2 4 1 1 2 1 1 2 4 8 ...
+static uint64_t luby(uint64_t i) {
+    uint64_t size = 1, exponent = 0;
+    while (size < i + 1) {
+        exponent++;
+        size = 2 * size + 1;
+    }
+    while (size - 1 != i) {
+        size = (size - 1) >> 1;
+        exponent--;
+        i = i % size;
+    }
+    return 1ull << exponent;
+}
+
+Solver::Solver(const SolverOptions& options)
+    : options(options), rng(options.seed) {}
+
+uint32_t Solver::newVar() {
+    uint32_t var = assigns.size();
+    watches.emplace_back();
+    watches.emplace_back();
+    assigns.push_back(VALUE_UNDEF);
+    polarity.push_back(1);
+    levels.push_back(0);
+    reasons.push_back(NO_REASON);
+    // a tiny random activity gives every seed its own initial order
+    activity.push_back(options.seed ? (rng() % 1000) * 1e-6 : 0);
+    heapIndex.push_back(-1);
+    seen.push_back(0);
+    levelStamp.push_back(0);
+    heapInsert(var);
+    return var;
+}
+
+uint32_t Solver::allocClause(const std::vector<SatLit>& lits, bool learnt,
+                             uint32_t lbd) {
+    uint32_t cref = arena.size();
+    arena.push_back((lits.size() << 1) | (learnt ? 1 : 0));
+    arena.push_back(lbd);
+    arena.insert(arena.end(), lits.begin(), lits.end());
+    return cref;
+}
+
+void Solver::attachClause(uint32_t cref) {
+    auto lits = clauseLits(cref);
+    watches[satNot(lits[0])].push_back(Watcher{cref, lits[1]});
+    watches[satNot(lits[1])].push_back(Watcher{cref, lits[0]});
+}
+
+bool Solver::addClause(std::vector<SatLit> lits) {
+    if (!ok) {
+        return false;
+    }
+    backtrack(0);
+
+    // drop duplicate and false literals, skip satisfied clauses
+    std::sort(lits.begin(), lits.end());
+    size_t j = 0;
+    for (size_t i = 0; i < lits.size(); i++) {
+        if (value(lits[i]) == VALUE_TRUE ||
+            (j > 0 && lits[j - 1] == satNot(lits[i]))) {
+            return true;
+        }
+        if (value(lits[i]) == VALUE_FALSE || (j > 0 && lits[j - 1] == lits[i])) {
+            continue;
+        }
+        lits[j++] = lits[i];
+    }
+    lits.resize(j);
+
+    if (lits.empty()) {
+        ok = false;
+    } else if (lits.size() == 1) {
+        enqueue(lits[0], NO_REASON);
+        ok = propagate() == NO_REASON;
+    } else {
+        auto cref = allocClause(lits, false, 0);
+        originals.push_back(cref);
+        attachClause(cref);
+    }
+    return ok;
+}
+
+void Solver::enqueue(SatLit lit, uint32_t reason) {
+    auto var = satVar(lit);
+    assigns[var] = satIsNegated(lit) ? VALUE_FALSE : VALUE_TRUE;
+    levels[var] = decisionLevel();
+    reasons[var] = reason;
+    trail.push_back(lit);
+}
+
+// Returns the conflicting clause or NO_REASON.
+uint32_t Solver::propagate() {
+    uint32_t conflict = NO_REASON;
+    while (propagateHead < trail.size()) {
+        SatLit p = trail[propagateHead++];
+        SatLit falseLit = satNot(p);
+        auto& ws = watches[p];
+        stats.propagations++;
+
+        size_t i = 0, j = 0;
+        while (i < ws.size()) {
+            auto w = ws[i];
+            if (value(w.blocker) == VALUE_TRUE) {
+                ws[j++] = ws[i++];
+                continue;
+            }
+
+            auto lits = clauseLits(w.cref);
+            if (lits[0] == falseLit) {
+                std::swap(lits[0], lits[1]);
+            }
+            i++;
+
+            SatLit first = lits[0];
+            Watcher watcher{w.cref, first};
+            if (first != w.blocker && value(first) == VALUE_TRUE) {
+                ws[j++] = watcher;
+                continue;
+            }
+
+            // look for a new literal to watch
+            auto size = clauseSize(w.cref);
+            bool moved = false;
+            for (uint32_t k = 2; k < size; k++) {
+                if (value(lits[k]) != VALUE_FALSE) {
+                    lits[1] = lits[k];
+                    lits[k] = falseLit;
+                    watches[satNot(lits[1])].push_back(watcher);
+                    moved = true;
+                    break;
+                }
+            }
+            if (moved) {
+                continue;
+            }
+
+            // the clause is unit or conflicting
+            ws[j++] = watcher;
+            if (value(first) == VALUE_FALSE) {
+                conflict = w.cref;
+                propagateHead = trail.size();
+                while (i < ws.size()) {
+                    ws[j++] = ws[i++];
+                }
+            } else {
+                enqueue(first, w.cref);
+            }
+        }
+        ws.resize(j);
+    }
+    return conflict;
+}
+
+// First UIP conflict analysis. Leaves the learnt clause in `learntClause`
+// with the asserting literal first and a literal of the backtrack level
+// second.
+void Solver::analyze(uint32_t conflict, uint32_t& backtrackLevel,
+                     uint32_t& lbd) {
+    learntClause.clear();
+    learntClause.push_back(0);
+    int pathCount = 0;
+    SatLit p = 0;
+    bool first = true;
+    size_t index = trail.size();
+
+    do {
+        auto lits = clauseLits(conflict);
+        auto size = clauseSize(conflict);
+        for (uint32_t k = first ? 0 : 1; k < size; k++) {
+            auto q = lits[k];
+            auto var = satVar(q);
+            if (seen[var] || levels[var] == 0) {
+                continue;
+            }
+            bumpVar(var);
+            seen[var] = 1;
+            if (levels[var] >= decisionLevel()) {
+                pathCount++;
+            } else {
+                learntClause.push_back(q);
+            }
+        }
+        first = false;
+
+        while (!seen[satVar(trail[--index])]) {
+        }
+        p = trail[index];
+        conflict = reasons[satVar(p)];
+        seen[satVar(p)] = 0;
+        pathCount--;
+    } while (pathCount > 0);
+    learntClause[0] = satNot(p);
+
+    // drop literals implied by the rest of the clause through their reason
+    analyzeToClear = learntClause;
+    size_t j = 1;
+    for (size_t i = 1; i < learntClause.size(); i++) {
+        auto var = satVar(learntClause[i]);
+        auto reason = reasons[var];
+        bool redundant = reason != NO_REASON;
+        if (redundant) {
+            auto lits = clauseLits(reason);
+            for (uint32_t k = 1; k < clauseSize(reason); k++) {
+                auto v = satVar(lits[k]);
+                if (!seen[v] && levels[v] > 0) {
+                    redundant = false;
+                    break;
+                }
+            }
+        }
+        if (!redundant) {
+            learntClause[j++] = learntClause[i];
+        }
+    }
+    learntClause.resize(j);
+    for (auto lit : analyzeToClear) {
+        seen[satVar(lit)] = 0;
+    }
+
+    backtrackLevel = 0;
+    if (learntClause.size() > 1) {
+        size_t maxIdx = 1;
+        for (size_t i = 2; i < learntClause.size(); i++) {
+            if (levels[satVar(learntClause[i])] >
+                levels[satVar(learntClause[maxIdx])]) {
+                maxIdx = i;
+            }
+        }
+        std::swap(learntClause[1], learntClause[maxIdx]);
+        backtrackLevel = levels[satVar(learntClause[1])];
+    }
+
+    // literal block distance: the number of distinct decision levels
+    if (levelStamp.size() <= decisionLevel()) {
+        levelStamp.resize(decisionLevel() + 1, 0);
+    }
+    stamp++;
+    lbd = 0;
+    for (auto lit : learntClause) {
+        auto level = levels[satVar(lit)];
+        if (levelStamp[level] != stamp) {
+            levelStamp[level] = stamp;
+            lbd++;
+        }
+    }
+}
+
+void Solver::backtrack(uint32_t level) {
+    if (decisionLevel() <= level) {
+        return;
+    }
+    for (size_t i = trail.size(); i > trailLimits[level]; i--) {
+        auto var = satVar(trail[i - 1]);
+        polarity[var] = satIsNegated(trail[i - 1]);
+        assigns[var] = VALUE_UNDEF;
+        reasons[var] = NO_REASON;
+        heapInsert(var);
+    }
+    trail.resize(trailLimits[level]);
+    trailLimits.resize(level);
+    propagateHead = trail.size();
+}
+
+void Solver::heapInsert(uint32_t var) {
+    if (heapIndex[var] >= 0) {
+        return;
+    }
+    heapIndex[var] = heap.size();
+    heap.push_back(var);
+    heapUp(heap.size() - 1);
+}
+
+void Solver::heapUp(size_t pos) {
+    auto var = heap[pos];
+    while (pos > 0) {
+        auto parent = (pos - 1) / 2;
+        if (activity[heap[parent]] >= activity[var]) {
+            break;
+        }
+        heap[pos] = heap[parent];
+        heapIndex[heap[pos]] = pos;
+        pos = parent;
+    }
+    heap[pos] = var;
+    heapIndex[var] = pos;
+}
+
+void Solver::heapDown(size_t pos) {
+    auto var = heap[pos];
+    while (2 * pos + 1 < heap.size()) {
+        auto child = 2 * pos + 1;
+        if (child + 1 < heap.size() &&
+            activity[heap[child + 1]] > activity[heap[child]]) {
+            child++;
+        }
+        if (activity[heap[child]] <= activity[var]) {
+            break;
+        }
+        heap[pos] = heap[child];
+        heapIndex[heap[pos]] = pos;
+        pos = child;
+    }
+    heap[pos] = var;
+    heapIndex[var] = pos;
+}
+
+uint32_t Solver::heapPop() {
+    auto top = heap[0];
+    heapIndex[top] = -1;
+    heap[0] = heap.back();
+    heap.pop_back();
+    if (!heap.empty()) {
+        heapIndex[heap[0]] = 0;
+        heapDown(0);
+    }
+    return top;
+}
+
+void Solver::bumpVar(uint32_t var) {
+    activity[var] += varIncrement;
+    if (activity[var] > 1e100) {
+        for (auto& a : activity) {
+            a *= 1e-100;
+        }
+        varIncrement *= 1e-100;
+    }
+    if (heapIndex[var] >= 0) {
+        heapUp(heapIndex[var]);
+    }
+}
+
+SatLit Solver::pickBranchLit() {
+    uint32_t var = UINT32_MAX;
+    if (options.randomDecisions > 0 && !heap.empty() &&
+        std::uniform_real_distribution<double>(0, 1)(rng) <
+            options.randomDecisions) {
+        var = heap[rng() % heap.size()];
+        if (assigns[var] != VALUE_UNDEF) {
+            var = UINT32_MAX;
+        }
+    }
+    while (var == UINT32_MAX && !heap.empty()) {
+        var = heapPop();
+        if (assigns[var] != VALUE_UNDEF) {
+            var = UINT32_MAX;
+        }
+    }
+    if (var == UINT32_MAX) {
+        return UINT32_MAX;
+    }
+
+    switch (options.phase) {
+    case PhasePolicy::ALWAYS_FALSE:
+        return satMakeLit(var, true);
+    case PhasePolicy::ALWAYS_TRUE:
+        return satMakeLit(var, false);
+    case PhasePolicy::RANDOM:
+        return satMakeLit(var, rng() & 1);
+    default:
+        return satMakeLit(var, polarity[var]);
+    }
+}
+
+bool Solver::clauseLocked(uint32_t cref) {
+    auto lit = clauseLits(cref)[0];
+    return reasons[satVar(lit)] == cref && value(lit) == VALUE_TRUE;
+}
+
+// Compacts the arena after learnt clauses were deleted, relocating reasons
+// and rebuilding every watch list. Deleted clauses are never reasons.
+void Solver::collectGarbage() {
+    std::vector<uint32_t> compacted;
+    compacted.reserve(arena.size() - wasted);
+    // the LBD word of a moved clause is reused to forward to its new place
+    auto relocate = [&](std::vector<uint32_t>& crefs) {
+        for (auto& cref : crefs) {
+            uint32_t moved = compacted.size();
+            compacted.insert(compacted.end(), arena.begin() + cref,
+                             arena.begin() + cref + 2 + clauseSize(cref));
+            arena[cref + 1] = moved;
+            cref = moved;
+        }
+    };
+    relocate(originals);
+    relocate(learnts);
+    for (auto lit : trail) {
+        auto& reason = reasons[satVar(lit)];
+        if (reason != NO_REASON) {
+            reason = arena[reason + 1];
+        }
+    }
+    arena.swap(compacted);
+    wasted = 0;
+
+    for (auto& ws : watches) {
+        ws.clear();
+    }
+    for (auto cref : originals) {
+        attachClause(cref);
+    }
+    for (auto cref : learnts) {
+        attachClause(cref);
+    }
+}
+
+// Deletes the half of the learnt clauses with the highest LBD, keeping glue
+// clauses (LBD <= 2) and clauses that are reasons on the trail.
+void Solver::reduceLearnts() {
+    std::stable_sort(learnts.begin(), learnts.end(),
+                     [&](uint32_t a, uint32_t b) {
+                         return arena[a + 1] < arena[b + 1];
+                     });
+    size_t keep = learnts.size() / 2;
+    size_t j = keep;
+    for (size_t i = keep; i < learnts.size(); i++) {
+        auto cref = learnts[i];
+        if (arena[cref + 1] <= 2 || clauseLocked(cref)) {
+            learnts[j++] = cref;
+        } else {
+            wasted += 2 + clauseSize(cref);
+        }
+    }
+    learnts.resize(j);
+    collectGarbage();
+}
+
+// Glucose style restarts fire when the LBD of recent learnt clauses is well
+// above the average so far, the other policies once the budget is spent.
+bool Solver::restartDue(uint64_t conflicts, uint64_t conflictBudget) {
+    if (conflicts >= conflictBudget) {
+        return true;
+    }
+    if (options.restarts != RestartPolicy::GLUCOSE ||
+        recentLbds.size() < RECENT_LBDS) {
+        return false;
+    }
+    double recent = (double)recentLbdSum / RECENT_LBDS;
+    double total = (double)totalLbdSum / std::max<uint64_t>(stats.learnts, 1);
+    if (recent * 0.8 <= total) {
+        return false;
+    }
+    recentLbds.clear();
+    recentLbdSum = 0;
+    return true;
+}
+
+// Adds the clauses other solvers shared since the last restart. They are
+// consequences of the same clauses, so they are kept like learnt ones.
+void Solver::importClauses() {
+    if (!exchange) {
+        return;
+    }
+    imported.clear();
+    exchange->collect(exchangeId, exchangeCursor, imported);
+    for (auto& lits : imported) {
+        stats.imported++;
+        size_t j = 0;
+        bool skip = false;
+        for (auto lit : lits) {
+            if (satVar(lit) >= varCount() || value(lit) == VALUE_TRUE) {
+                skip = true;
+                break;
+            }
+            if (value(lit) == VALUE_UNDEF) {
+                lits[j++] = lit;
+            }
+        }
+        if (skip) {
+            continue;
+        }
+        lits.resize(j);
+
+        if (lits.empty()) {
+            ok = false;
+            return;
+        } else if (lits.size() == 1) {
+            enqueue(lits[0], NO_REASON);
+            if (propagate() != NO_REASON) {
+                ok = false;
+                return;
+            }
+        } else {
+            auto cref = allocClause(lits, true, lits.size());
+            learnts.push_back(cref);
+            attachClause(cref);
+        }
+    }
+}
+
+SatResult Solver::search(uint64_t conflictBudget,
+                         const std::vector<SatLit>& assumptions) {
+    uint64_t conflicts = 0;
+    while (true) {
+        auto conflict = propagate();
+        if (conflict != NO_REASON) {
+            stats.conflicts++;
+            conflicts++;
+            if (decisionLevel() == 0) {
+                ok = false;
+                return SatResult::UNSATISFIABLE;
+            }
+
+            uint32_t backtrackLevel, lbd;
+            analyze(conflict, backtrackLevel, lbd);
+            backtrack(backtrackLevel);
+            if (learntClause.size() == 1) {
+                enqueue(learntClause[0], NO_REASON);
+            } else {
+                auto cref = allocClause(learntClause, true, lbd);
+                learnts.push_back(cref);
+                attachClause(cref);
+                enqueue(learntClause[0], cref);
+            }
+            stats.learnts++;
+            varIncrement /= 0.95;
+
+            if (exchange &&
+                learntClause.size() <= ClauseExchange::MAX_CLAUSE_SIZE) {
+                exchange->publish(exchangeId, learntClause);
+                stats.exported++;
+            }
+            totalLbdSum += lbd;
+            recentLbds.push_back(lbd);
+            recentLbdSum += lbd;
+            if (recentLbds.size() > RECENT_LBDS) {
+                recentLbdSum -= recentLbds.front();
+                recentLbds.pop_front();
+            }
+            continue;
+        }
+
+        if (restartDue(conflicts, conflictBudget) || interrupted()) {
+            backtrack(0);
+            return SatResult::UNKNOWN;
+        }
+        if (learnts.size() >= maxLearnts + trail.size()) {
+            reduceLearnts();
+            maxLearnts += maxLearnts / 10;
+        }
+
+        // assumptions are the first decisions, one level each
+        SatLit next = UINT32_MAX;
+        while (decisionLevel() < assumptions.size()) {
+            auto p = assumptions[decisionLevel()];
+            if (value(p) == VALUE_TRUE) {
+                trailLimits.push_back(trail.size());
+            } else if (value(p) == VALUE_FALSE) {
+                return SatResult::UNSATISFIABLE;
+            } else {
+                next = p;
+                break;
+            }
+        }
+        if (next == UINT32_MAX) {
+            stats.decisions++;
+            next = pickBranchLit();
+            if (next == UINT32_MAX) {
+                return SatResult::SATISFIABLE;
+            }
+        }
+        trailLimits.push_back(trail.size());
+        enqueue(next, NO_REASON);
+    }
+}
+
+SatResult Solver::solve(const std::vector<SatLit>& assumptions) {
+    stats.solves++;
+    if (!ok) {
+        return SatResult::UNSATISFIABLE;
+    }
+
+    auto startConflicts = stats.conflicts;
+    auto result = SatResult::UNKNOWN;
+    for (uint64_t restart = 0; result == SatResult::UNKNOWN; restart++) {
+        importClauses();
+        if (!ok) {
+            result = SatResult::UNSATISFIABLE;
+            break;
+        }
+        if (interrupted()) {
+            break;
+        }
+
+        uint64_t budget;
+        switch (options.restarts) {
+        case RestartPolicy::GEOMETRIC:
+            budget = 100 * std::pow(1.5, std::min<uint64_t>(restart, 60));
+            break;
+        case RestartPolicy::GLUCOSE:
+            budget = UINT64_MAX;
+            break;
+        default:
+            budget = 100 * luby(restart);
+        }
+        if (conflictLimit >= 0) {
+            uint64_t used = stats.conflicts - startConflicts;
+            if (used >= (uint64_t)conflictLimit) {
+                break;
+            }
+            budget = std::min(budget, conflictLimit - used);
+        }
+        result = search(budget, assumptions);
+        if (result == SatResult::UNKNOWN) {
+            stats.restarts++;
+        }
+    }
+
+    if (result == SatResult::SATISFIABLE) {
+        model.assign(assigns.size(), false);
+        for (size_t var = 0; var < assigns.size(); var++) {
+            model[var] = assigns[var] == VALUE_TRUE;
+        }
+    }
+    backtrack(0);
+    return result;
+}
@@ -0,0 +1,189 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <vector>
+
+class ClauseExchange;
+
+// A solver literal is a variable index shifted left by one with the lowest
+// bit set for negation, the same layout as AIG literals.
+using SatLit = uint32_t;
+
+inline SatLit satMakeLit(uint32_t var, bool negated = false) {
+    return (var << 1) | (negated ? 1 : 0);
+}
+inline uint32_t satVar(SatLit lit) { return lit >> 1; }
+inline bool satIsNegated(SatLit lit) { return lit & 1; }
+inline SatLit satNot(SatLit lit) { return lit ^ 1; }
+
+enum class SatResult { SATISFIABLE, UNSATISFIABLE, UNKNOWN };
+
+enum class RestartPolicy { LUBY, GEOMETRIC, GLUCOSE };
+enum class PhasePolicy { SAVED, ALWAYS_FALSE, ALWAYS_TRUE, RANDOM };
+
+struct SolverOptions {
+    RestartPolicy restarts = RestartPolicy::LUBY;
+    PhasePolicy phase = PhasePolicy::SAVED;
+    // Seeds random decisions, random phases and the initial variable order.
+    // Seed 0 keeps the deterministic default order.
+    uint64_t seed = 0;
+    // Fraction of decisions made on a random variable.
+    double randomDecisions = 0;
+};
+
+struct SolverStats {
+    uint64_t solves = 0;
+    uint64_t decisions = 0;
+    uint64_t propagations = 0;
+    uint64_t conflicts = 0;
+    uint64_t restarts = 0;
+    uint64_t learnts = 0;
+    uint64_t exported = 0;
+    uint64_t imported = 0;
+};
+
+// Conflict driven clause learning SAT solver with two watched literals,
+// VSIDS branching, phase saving, Luby, geometric or glucose style restarts
+// and LBD based learnt clause reduction.
+//
+// The solver is incremental: clauses may be added between calls to solve(),
+// learnt clauses are kept from one call to the next, and every call may pass
+// assumption literals that only hold for that call.
+//
+// Several solvers working on the same clauses can run in parallel threads:
+// they share short learnt clauses through a ClauseExchange, and all of them
+// stop once one sets the shared interrupt flag.
+class Solver {
+private:
+    static constexpr uint32_t NO_REASON = UINT32_MAX;
+    static constexpr uint8_t VALUE_TRUE = 0;
+    static constexpr uint8_t VALUE_FALSE = 1;
+    static constexpr uint8_t VALUE_UNDEF = 2;
+
+    struct Watcher {
+        uint32_t cref;
+        SatLit blocker;
+    };
+
+    // Clauses live in one flat arena: a header word holding the size and
+    // the learnt flag, a word holding the LBD, then the literals. The two
+    // watched literals are always the first two.
+    std::vector<uint32_t> arena;
+    std::vector<uint32_t> originals;
+    std::vector<uint32_t> learnts;
+    size_t wasted = 0;
+
+    std::vector<std::vector<Watcher>> watches;
+    std::vector<uint8_t> assigns;
+    std::vector<uint8_t> polarity;
+    std::vector<uint32_t> levels;
+    std::vector<uint32_t> reasons;
+    std::vector<SatLit> trail;
+    std::vector<size_t> trailLimits;
+    size_t propagateHead = 0;
+
+    std::vector<double> activity;
+    double varIncrement = 1.0;
+    std::vector<uint32_t> heap;
+    std::vector<int64_t> heapIndex;
+
+    std::vector<uint8_t> seen;
+    std::vector<SatLit> learntClause;
+    std::vector<SatLit> analyzeToClear;
+    std::vector<uint32_t> levelStamp;
+    uint32_t stamp = 0;
+
+    SolverOptions options;
+    std::mt19937_64 rng;
+    // moving averages of learnt clause LBDs for glucose style restarts
+    std::deque<uint32_t> recentLbds;
+    uint64_t recentLbdSum = 0;
+    uint64_t totalLbdSum = 0;
+
+    ClauseExchange* exchange = nullptr;
+    uint32_t exchangeId = 0;
+    std::vector<std::vector<SatLit>> imported;
+    uint64_t exchangeCursor = 0;
+    const std::atomic<bool>* interrupt = nullptr;
+
+    std::vector<bool> model;
+    bool ok = true;
+    int64_t conflictLimit = -1;
+    size_t maxLearnts = 4000;
+    SolverStats stats;
+
+    uint8_t value(SatLit lit) const {
+        uint8_t v = assigns[satVar(lit)];
+        return v == VALUE_UNDEF ? v : v ^ (lit & 1);
+    }
+    uint32_t decisionLevel() const { return trailLimits.size(); }
+
+    uint32_t clauseSize(uint32_t cref) const { return arena[cref] >> 1; }
+    bool clauseLearnt(uint32_t cref) const { return arena[cref] & 1; }
+    SatLit* clauseLits(uint32_t cref) { return &arena[cref + 2]; }
+
+    uint32_t allocClause(const std::vector<SatLit>& lits, bool learnt,
+                         uint32_t lbd);
+    void attachClause(uint32_t cref);
+    bool clauseLocked(uint32_t cref);
+    void collectGarbage();
+    void reduceLearnts();
+
+    void enqueue(SatLit lit, uint32_t reason);
+    uint32_t propagate();
+    void analyze(uint32_t conflict, uint32_t& backtrackLevel, uint32_t& lbd);
+    void backtrack(uint32_t level);
+
+    void heapInsert(uint32_t var);
+    void heapUp(size_t pos);
+    void heapDown(size_t pos);
+    uint32_t heapPop();
+    void bumpVar(uint32_t var);
+    SatLit pickBranchLit();
+
+    bool interrupted() const {
+        return interrupt && interrupt->load(std::memory_order_relaxed);
+    }
+    bool restartDue(uint64_t conflicts, uint64_t conflictBudget);
+    void importClauses();
+    SatResult search(uint64_t conflictBudget,
+                     const std::vector<SatLit>& assumptions);
+
+public:
+    Solver(const SolverOptions& options = SolverOptions());
+
+    uint32_t newVar();
+    size_t varCount() const { return assigns.size(); }
+
+    // Adds a clause permanently. Returns false once the clauses added so far
+    // are unsatisfiable on their own.
+    bool addClause(std::vector<SatLit> lits);
+    SatResult solve(const std::vector<SatLit>& assumptions = {});
+
+    // Limits the number of conflicts of each solve() call, which then returns
+    // UNKNOWN when it runs out. A negative limit means no limit.
+    void setConflictLimit(int64_t limit) { conflictLimit = limit; }
+    // Makes solve() return UNKNOWN soon after the flag becomes true.
+    void setInterrupt(const std::atomic<bool>* flag) { interrupt = flag; }
+    // Shares learnt clauses of at most ClauseExchange::MAX_CLAUSE_SIZE
+    // literals with the other solvers attached to the exchange, importing
+    // theirs at every restart. All of them must work on the same clauses
+    // over the same variables.
+    void setExchange(ClauseExchange* exchange, uint32_t id) {
+        this->exchange = exchange;
+        exchangeId = id;
+    }
+
+    // Value of a literal in the last satisfying assignment.
+    bool modelValue(SatLit lit) const {
+        return model[satVar(lit)] != satIsNegated(lit);
+    }
+    const SolverStats& getStats() const { return stats; }
+};
+
+#endif // SOLVER_H
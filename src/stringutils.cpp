@@ -1,6 +1,5 @@
 #include "stringutils.hpp"
 #include <cctype>
-#include <sstream>
 #include <vector>
 
 // trim from start (in place)
@@ -24,14 +23,37 @@ void trim(std::string& s) {
     rtrim(s);
 }
 
-std::vector<std::string> split(const std::string& s, char delimiter) {
-    std::vector<std::string> tokens;
-    std::stringstream ss(s);
-    std::string item;
-
-    while (std::getline(ss, item, delimiter)) {
-        tokens.push_back(item);
+std::string_view trimmed(std::string_view s) {
+    auto space = [](unsigned char ch) { return std::isspace(ch) != 0; };
+    while (!s.empty() && space(s.front())) {
+        s.remove_prefix(1);
+    }
+    while (!s.empty() && space(s.back())) {
+        s.remove_suffix(1);
     }
+    return s;
+}
 
-    return tokens;
-}
\ No newline at end of file
+bool ListSplitter::next(std::string_view& piece) {
+    if (done) {
+        return false;
+    }
+    // a closing parenthesis without an opening one does not nest
+    size_t depth = 0;
+    for (size_t i = 0; i < rest.size(); i++) {
+        char c = rest[i];
+        if (c == '(') {
+            depth++;
+        } else if (c == ')') {
+            depth -= depth > 0;
+        } else if (c == delimiter && depth == 0) {
+            piece = trimmed(rest.substr(0, i));
+            rest.remove_prefix(i + 1);
+            done = rest.empty();
+            return true;
+        }
+    }
+    piece = trimmed(rest);
+    done = true;
+    return true;
+}
@@ -3,6 +3,7 @@
 
 #include <algorithm>
 #include <string>
+#include <string_view>
 #include <vector>
 
 // trim from start (in place)
@@ -14,6 +15,25 @@ void rtrim(std::string& s);
 // trim string from both ends
 void trim(std::string& s);
 
-std::vector<std::string> split(const std::string& s, char delimiter);
+// the view without its leading and trailing whitespace
+std::string_view trimmed(std::string_view s);
+
+// Splits a list of expressions at the delimiters outside parentheses,
+// yielding trimmed views into the original buffer without copying it. A
+// trailing delimiter does not start another (empty) piece, unbalanced
+// parentheses are left for the lexer to report.
+class ListSplitter {
+private:
+    std::string_view rest;
+    char delimiter;
+    bool done;
+
+public:
+    ListSplitter(std::string_view s, char delimiter = ',')
+        : rest(s), delimiter(delimiter), done(false) {}
+
+    // Stores the next piece in `piece`, false once the list is exhausted.
+    bool next(std::string_view& piece);
+};
 
 #endif // STRINGUTILS_H
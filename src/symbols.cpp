@@ -0,0 +1,52 @@
+#include "symbols.hpp"
+
+SymbolTable::SymbolTable() : slots(64, Slot{0, 0}) {}
+
+// FNV-1a, names are short
+uint32_t SymbolTable::hash(std::string_view name) {
+    uint32_t h = 2166136261u;
+    for (char c : name) {
+        h = (h ^ (unsigned char)c) * 16777619u;
+    }
+    return h;
+}
+
+void SymbolTable::grow() {
+    std::vector<Slot> old(slots.size() * 2, Slot{0, 0});
+    old.swap(slots);
+    const size_t mask = slots.size() - 1;
+    for (auto& slot : old) {
+        if (slot.id == 0) {
+            continue;
+        }
+        size_t i = slot.hash & mask;
+        while (slots[i].id != 0) {
+            i = (i + 1) & mask;
+        }
+        slots[i] = slot;
+    }
+}
+
+uint32_t SymbolTable::intern(std::string_view name) {
+    const uint32_t h = hash(name);
+    const size_t mask = slots.size() - 1;
+    size_t i = h & mask;
+    for (; slots[i].id != 0; i = (i + 1) & mask) {
+        if (slots[i].hash == h && names[slots[i].id - 1] == name) {
+            return slots[i].id - 1;
+        }
+    }
+    uint32_t id = names.size();
+    names.emplace_back(name);
+    slots[i] = Slot{h, id + 1};
+    // keep the table at most half full
+    if (names.size() * 2 > slots.size()) {
+        grow();
+    }
+    return id;
+}
+
+SymbolTable& symbols() {
+    static SymbolTable table;
+    return table;
+}
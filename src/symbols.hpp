@@ -0,0 +1,42 @@
+#ifndef SYMBOLS_H
+#define SYMBOLS_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Interns variable names. Every distinct name gets a dense id, in the order
+// names are first seen, so the stages after the lexer can index vectors by
+// id instead of hashing names. A table is not safe to use from several threads
+// at once, threads lexing in parallel each intern into one of their own.
+class SymbolTable {
+private:
+    std::vector<std::string> names;
+    // open addressing over a power of two number of slots, each holding the
+    // hash of a name and its id plus one (zero marks an empty slot)
+    struct Slot {
+        uint32_t hash;
+        uint32_t id;
+    };
+    std::vector<Slot> slots;
+
+    static uint32_t hash(std::string_view name);
+    void grow();
+
+public:
+    SymbolTable();
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
+
+    // Returns the id of `name`, adding it when it is new.
+    uint32_t intern(std::string_view name);
+    const std::string& name(uint32_t id) const { return names[id]; }
+    size_t size() const { return names.size(); }
+};
+
+// The table shared by every expression of the session. Names are never
+// removed, so ids stay valid for the life of the process.
+SymbolTable& symbols();
+
+#endif // SYMBOLS_H
@@ -0,0 +1,194 @@
+#include "tablefile.hpp"
+#include "outbuf.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static std::runtime_error fileError(const std::string& what,
+                                    const std::string& path) {
+    return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+static void appendName(std::string& out, const std::string& name) {
+    uint32_t length = name.size();
+    out.append(reinterpret_cast<const char*>(&length), sizeof(length));
+    out += name;
+}
+
+std::string encodeTableNames(const TruthTable& table) {
+    std::string names;
+    for (auto& name : table.getVariables()) {
+        appendName(names, name);
+    }
+    appendName(names, table.getExpression());
+    return names;
+}
+
+bool decodeTableNames(const char* data, size_t size, uint32_t variableCount,
+                      std::vector<std::string>& variables,
+                      std::string& expression) {
+    size_t offset = 0;
+    for (uint32_t i = 0; i <= variableCount; i++) {
+        uint32_t length;
+        if (offset + sizeof(length) > size) {
+            return false;
+        }
+        std::memcpy(&length, data + offset, sizeof(length));
+        offset += sizeof(length);
+        if (length > size - offset) {
+            return false;
+        }
+        std::string name(data + offset, length);
+        offset += length;
+        if (i < variableCount) {
+            variables.push_back(name);
+        } else {
+            expression = name;
+        }
+    }
+    return true;
+}
+
+uint64_t writeTableFile(TruthTable& table, const std::string& path) {
+    TableFileHeader header;
+    std::memcpy(header.magic, TABLE_FILE_MAGIC, sizeof(header.magic));
+    header.byteOrder = TABLE_FILE_BYTE_ORDER;
+    header.variableCount = table.variableCount();
+    header.rowCount = table.rowCount();
+    header.ones = 0;
+
+    auto names = encodeTableNames(table);
+    size_t end = sizeof(header) + names.size();
+    header.dataOffset =
+        (end + TABLE_FILE_ALIGNMENT - 1) / TABLE_FILE_ALIGNMENT *
+        TABLE_FILE_ALIGNMENT;
+
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw fileError("cannot open", path);
+    }
+    uint64_t size = 0;
+    try {
+        OutputBuffer out(fd);
+        // the count of true rows is only known at the end, the header is
+        // rewritten then
+        out.append(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.append(names);
+        out.append(std::string(header.dataOffset - end, '\0'));
+
+        std::vector<uint64_t> words(TruthTable::BATCH_ROWS / 64);
+        const uint64_t total = table.wordCount();
+        for (uint64_t first = 0; first < total; first += words.size()) {
+            size_t count = std::min<uint64_t>(words.size(), total - first);
+            table.evaluate(first, count, words.data());
+            for (size_t w = 0; w < count; w++) {
+                header.ones += __builtin_popcountll(words[w]);
+            }
+            out.append(reinterpret_cast<const char*>(words.data()),
+                       count * sizeof(uint64_t));
+        }
+        out.flush();
+        size = out.bytesWritten();
+        if (::pwrite(fd, &header, sizeof(header), 0) != sizeof(header)) {
+            throw fileError("cannot write", path);
+        }
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    if (::close(fd) != 0) {
+        throw fileError("cannot write", path);
+    }
+    return size;
+}
+
+TableFile::TableFile(const std::string& path) {
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw fileError("cannot open", path);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        auto error = fileError("cannot stat", path);
+        ::close(fd);
+        throw error;
+    }
+    size = st.st_size;
+    if (size < sizeof(header)) {
+        ::close(fd);
+        throw std::runtime_error(path + " is not a truth table file");
+    }
+    void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) {
+        auto error = fileError("cannot map", path);
+        ::close(fd);
+        throw error;
+    }
+    base = static_cast<const char*>(mapped);
+
+    // the destructor does not run for a throwing constructor
+    auto fail = [&](const std::string& why) {
+        ::munmap(const_cast<char*>(base), size);
+        ::close(fd);
+        return std::runtime_error(path + ": " + why);
+    };
+
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, TABLE_FILE_MAGIC, sizeof(header.magic))) {
+        throw fail("not a truth table file");
+    }
+    if (header.byteOrder != TABLE_FILE_BYTE_ORDER) {
+        throw fail("written with a different byte order");
+    }
+    if (header.variableCount > TruthTable::MAX_VARIABLES ||
+        header.rowCount != 1ull << header.variableCount ||
+        header.dataOffset % TABLE_FILE_ALIGNMENT != 0 ||
+        header.dataOffset < sizeof(header) || header.dataOffset > size ||
+        (size - header.dataOffset) / sizeof(uint64_t) < wordCount()) {
+        throw fail("truncated or corrupt header");
+    }
+
+    if (!decodeTableNames(base + sizeof(header),
+                          header.dataOffset - sizeof(header),
+                          header.variableCount, variables, expression)) {
+        throw fail("truncated names");
+    }
+    words = reinterpret_cast<const uint64_t*>(base + header.dataOffset);
+}
+
+TableFile::~TableFile() {
+    ::munmap(const_cast<char*>(base), size);
+    ::close(fd);
+}
+
+uint64_t TableFile::compare(TruthTable& table,
+                            uint64_t& firstDifference) const {
+    if (table.getVariables() != variables) {
+        throw std::runtime_error("tables are over different variables");
+    }
+    ::madvise(const_cast<char*>(base), size, MADV_SEQUENTIAL);
+    uint64_t differing = 0;
+    firstDifference = header.rowCount;
+    std::vector<uint64_t> fresh(TruthTable::BATCH_ROWS / 64);
+    const uint64_t total = wordCount();
+    for (uint64_t first = 0; first < total; first += fresh.size()) {
+        size_t count = std::min<uint64_t>(fresh.size(), total - first);
+        table.evaluate(first, count, fresh.data());
+        for (size_t w = 0; w < count; w++) {
+            uint64_t diff = fresh[w] ^ words[first + w];
+            if (diff == 0) {
+                continue;
+            }
+            if (differing == 0) {
+                firstDifference = 64 * (first + w) + __builtin_ctzll(diff);
+            }
+            differing += __builtin_popcountll(diff);
+        }
+    }
+    ::madvise(const_cast<char*>(base), size, MADV_NORMAL);
+    return differing;
+}
@@ -0,0 +1,89 @@
+#ifndef TABLEFILE_H
+#define TABLEFILE_H
+
+#include "truthtable.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Binary truth table file, in native (little endian) byte order:
+//
+//   header      TableFileHeader
+//   names       per variable, then for the expression: a uint32 length
+//               followed by that many bytes
+//   padding     up to dataOffset, a multiple of TABLE_FILE_ALIGNMENT
+//   data        the packed result column, ceil(rowCount / 64) uint64 words
+//               laid out like TruthTable::evaluate() returns them
+//
+// Aligning the data lets a reader map the file and index the column in
+// place.
+const size_t TABLE_FILE_ALIGNMENT = 4096;
+const char TABLE_FILE_MAGIC[8] = {'P', 'N', 'S', 'V', 'T', 'T', '\0', '\1'};
+const uint32_t TABLE_FILE_BYTE_ORDER = 0x01020304;
+
+struct TableFileHeader {
+    char magic[8];
+    uint32_t byteOrder;
+    uint32_t variableCount;
+    uint64_t rowCount;
+    uint64_t dataOffset;
+    // rows in which the expression is true
+    uint64_t ones;
+};
+
+// The variable names and then the expression, each as a uint32 length
+// followed by that many bytes.
+std::string encodeTableNames(const TruthTable& table);
+// Reads back names encoded as above from `size` bytes at `data`. Returns
+// false when they are truncated.
+bool decodeTableNames(const char* data, size_t size, uint32_t variableCount,
+                      std::vector<std::string>& variables,
+                      std::string& expression);
+
+// Writes the table to `path` and returns the size of the file. Throws
+// std::runtime_error when the file cannot be written.
+uint64_t writeTableFile(TruthTable& table, const std::string& path);
+
+// Read-only view of a table file through mmap(2). Nothing but the header and
+// the names is read up front; pages of the column are faulted in as rows
+// are looked at.
+class TableFile {
+private:
+    int fd = -1;
+    const char* base = nullptr;
+    size_t size = 0;
+    TableFileHeader header;
+    const uint64_t* words = nullptr;
+    std::vector<std::string> variables;
+    std::string expression;
+
+public:
+    // Throws std::runtime_error when the file cannot be mapped or is not a
+    // valid table file.
+    TableFile(const std::string& path);
+    ~TableFile();
+    TableFile(const TableFile&) = delete;
+    TableFile& operator=(const TableFile&) = delete;
+
+    const std::vector<std::string>& getVariables() const { return variables; }
+    const std::string& getExpression() const { return expression; }
+    uint64_t rowCount() const { return header.rowCount; }
+    uint64_t wordCount() const { return (header.rowCount + 63) / 64; }
+    uint64_t ones() const { return header.ones; }
+    size_t fileSize() const { return size; }
+    const uint64_t* getWords() const { return words; }
+
+    bool row(uint64_t r) const { return (words[r >> 6] >> (r & 63)) & 1; }
+    // Value in `column`, the result being column getVariables().size().
+    bool cell(size_t column, uint64_t r) const {
+        return column < variables.size()
+                   ? TruthTable::variableValue(column, variables.size(), r)
+                   : row(r);
+    }
+
+    // Number of rows in which the stored column and a table over the same
+    // variables differ. `firstDifference` receives the first such row.
+    uint64_t compare(TruthTable& table, uint64_t& firstDifference) const;
+};
+
+#endif // TABLEFILE_H
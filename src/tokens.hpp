@@ -1,12 +1,15 @@
 #ifndef TOKEN_H
 #define TOKEN_H
 
+#include <cstdint>
+#include <memory_resource>
 #include <string>
+#include <type_traits>
 #include <vector>
 
-enum class Associativity { LEFT, RIGHT };
+enum class Associativity : uint8_t { LEFT, RIGHT };
 
-enum class TokenType {
+enum class TokenType : uint8_t {
     VARIABLE,
     NEGATION_OP,
     OR_OP,
@@ -18,37 +21,85 @@ enum class TokenType {
     RPAREN
 };
 
+struct TokenTraits {
+    int precedence;
+    Associativity associativity;
+    const char* text;
+};
+
+// Precedence, associativity and text of each token type, in TokenType
+// order.
+inline constexpr TokenTraits TOKEN_TRAITS[] = {
+    {0, Associativity::LEFT, ""},   // VARIABLE
+    {6, Associativity::RIGHT, "!"}, // NEGATION_OP
+    {3, Associativity::LEFT, "|"},  // OR_OP
+    {5, Associativity::LEFT, "&"},  // AND_OP
+    {4, Associativity::LEFT, "^"},  // XOR_OP
+    {2, Associativity::RIGHT, ">"}, // IMLPICATION_OP
+    {1, Associativity::LEFT, "="},  // BICONDITIONAL_OP
+    {0, Associativity::LEFT, "("},  // LPAREN
+    {0, Associativity::LEFT, ")"},  // RPAREN
+};
+
+class SymbolTable;
+
+// A token is its type and, for variables, the id of its name in the symbol
+// table the lexer interned it into, packed into 8 bytes so that token vectors stay small and are
+// copied with plain moves.
 class Token {
 protected:
-    std::string value;
     TokenType tokenType;
-    int precedence;
-    Associativity associativity;
+    uint32_t symbol;
 
 public:
-    Token(const std::string& value, TokenType tokenType, int precedence,
-          Associativity associativity);
-
-    std::string getValue() const;
-    TokenType getTokenType() const;
-    int getPrecedence() const;
-    Associativity getAssociativity() const;
-
-    bool operator==(const Token& other) const;
-    bool isVariable();
-    bool isUnaryOperator();
-    bool isParen();
+    constexpr Token(TokenType tokenType, uint32_t symbol = 0)
+        : tokenType(tokenType), symbol(symbol) {}
+
+    // The variable name, looked up in the lexer's table, or the operator
+    // symbol.
+    std::string getValue(const SymbolTable& names) const;
+    uint32_t getSymbol() const { return symbol; }
+    TokenType getTokenType() const { return tokenType; }
+    int getPrecedence() const {
+        return TOKEN_TRAITS[(int)tokenType].precedence;
+    }
+    Associativity getAssociativity() const {
+        return TOKEN_TRAITS[(int)tokenType].associativity;
+    }
+
+    bool operator==(const Token& other) const {
+        return tokenType == other.tokenType;
+    }
+    bool isVariable() const { return tokenType == TokenType::VARIABLE; }
+    bool isUnaryOperator() const {
+        return tokenType == TokenType::NEGATION_OP;
+    }
+    bool isParen() const {
+        return tokenType == TokenType::LPAREN ||
+               tokenType == TokenType::RPAREN;
+    }
 };
 
+static_assert(sizeof(Token) == 8 && std::is_trivially_copyable_v<Token>,
+              "tokens are meant to be packed");
+
+// The tokens of an expression, in memory of the caller's choosing (see
+// Arena).
+using TokenList = std::pmr::vector<Token>;
+
 // Factory functions for creating tokens
-Token VariableToken(std::string name);
-Token NegationToken();
-Token OrToken();
-Token AndToken();
-Token XorToken();
-Token ImplicationToken();
-Token BiconditionalToken();
-Token LPARENToken();
-Token RPARENToken();
+constexpr Token VariableToken(uint32_t symbol) {
+    return Token(TokenType::VARIABLE, symbol);
+}
+constexpr Token NegationToken() { return Token(TokenType::NEGATION_OP); }
+constexpr Token OrToken() { return Token(TokenType::OR_OP); }
+constexpr Token AndToken() { return Token(TokenType::AND_OP); }
+constexpr Token XorToken() { return Token(TokenType::XOR_OP); }
+constexpr Token ImplicationToken() { return Token(TokenType::IMLPICATION_OP); }
+constexpr Token BiconditionalToken() {
+    return Token(TokenType::BICONDITIONAL_OP);
+}
+constexpr Token LPARENToken() { return Token(TokenType::LPAREN); }
+constexpr Token RPARENToken() { return Token(TokenType::RPAREN); }
 
 #endif // TOKEN_H
@@ -0,0 +1,119 @@
+#include "transpose.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TRANSPOSE_X86 1
+#endif
+
+// Every kernel runs the same six rounds: round j swaps the upper j columns
+// of the rows whose index has bit j clear with the lower j columns of the
+// rows j further down, the mask selecting the lower columns of each pair.
+static const uint64_t MASKS[6] = {
+    0x00000000ffffffffull, 0x0000ffff0000ffffull, 0x00ff00ff00ff00ffull,
+    0x0f0f0f0f0f0f0f0full, 0x3333333333333333ull, 0x5555555555555555ull,
+};
+
+static inline void swapRows(uint64_t& a, uint64_t& b, unsigned j,
+                            uint64_t mask) {
+    uint64_t t = ((a >> j) ^ b) & mask;
+    b ^= t;
+    a ^= t << j;
+}
+
+static void transposeScalar(uint64_t* block) {
+    unsigned j = 32;
+    for (int round = 0; round < 6; round++, j >>= 1) {
+        for (unsigned k = 0; k < 64; k = (k + j + 1) & ~j) {
+            swapRows(block[k], block[k + j], j, MASKS[round]);
+        }
+    }
+}
+
+#ifdef TRANSPOSE_X86
+// Two rows per register: rounds down to j = 2 pair up whole registers,
+// the last one swaps within each register.
+__attribute__((target("sse2"))) static void transposeSse2(uint64_t* block) {
+    auto p = reinterpret_cast<__m128i*>(block);
+    unsigned j = 32;
+    for (int round = 0; round < 5; round++, j >>= 1) {
+        const __m128i mask = _mm_set1_epi64x(MASKS[round]);
+        const __m128i shift = _mm_cvtsi32_si128(j);
+        for (unsigned k = 0; k < 64; k = (k + j + 2) & ~j) {
+            __m128i a = _mm_loadu_si128(p + k / 2);
+            __m128i b = _mm_loadu_si128(p + (k + j) / 2);
+            __m128i t = _mm_and_si128(_mm_xor_si128(_mm_srl_epi64(a, shift), b),
+                                      mask);
+            _mm_storeu_si128(p + (k + j) / 2, _mm_xor_si128(b, t));
+            _mm_storeu_si128(p + k / 2, _mm_xor_si128(a, _mm_sll_epi64(t, shift)));
+        }
+    }
+    for (unsigned k = 0; k < 64; k += 2) {
+        swapRows(block[k], block[k + 1], 1, MASKS[5]);
+    }
+}
+
+// Four rows per register: rounds down to j = 4 pair up whole registers,
+// the last two pair up lanes of the same register.
+__attribute__((target("avx2"))) static void transposeAvx2(uint64_t* block) {
+    auto p = reinterpret_cast<__m256i*>(block);
+    unsigned j = 32;
+    for (int round = 0; round < 4; round++, j >>= 1) {
+        const __m256i mask = _mm256_set1_epi64x(MASKS[round]);
+        for (unsigned k = 0; k < 64; k = (k + j + 4) & ~j) {
+            __m256i a = _mm256_loadu_si256(p + k / 4);
+            __m256i b = _mm256_loadu_si256(p + (k + j) / 4);
+            __m256i t = _mm256_and_si256(
+                _mm256_xor_si256(_mm256_srli_epi64(a, j), b), mask);
+            _mm256_storeu_si256(p + (k + j) / 4, _mm256_xor_si256(b, t));
+            _mm256_storeu_si256(p + k / 4,
+                                _mm256_xor_si256(a, _mm256_slli_epi64(t, j)));
+        }
+    }
+    // lanes 0, 1 pair with lanes 2, 3, then lanes 0, 2 with lanes 1, 3
+    const __m256i mask2 = _mm256_set1_epi64x(MASKS[4]);
+    const __m256i mask1 = _mm256_set1_epi64x(MASKS[5]);
+    for (unsigned k = 0; k < 16; k++) {
+        __m256i x = _mm256_loadu_si256(p + k);
+        __m256i y = _mm256_permute4x64_epi64(x, 0x4e);
+        __m256i t = _mm256_and_si256(
+            _mm256_xor_si256(_mm256_srli_epi64(x, 2), y), mask2);
+        // the low lanes receive t << 2, the high lanes t from their partner
+        __m256i tt = _mm256_permute4x64_epi64(t, 0x4e);
+        x = _mm256_xor_si256(
+            x, _mm256_blend_epi32(_mm256_slli_epi64(t, 2), tt, 0xf0));
+
+        y = _mm256_shuffle_epi32(x, 0x4e);
+        t = _mm256_and_si256(_mm256_xor_si256(_mm256_srli_epi64(x, 1), y),
+                             mask1);
+        tt = _mm256_shuffle_epi32(t, 0x4e);
+        x = _mm256_xor_si256(
+            x, _mm256_blend_epi32(_mm256_slli_epi64(t, 1), tt, 0xcc));
+        _mm256_storeu_si256(p + k, x);
+    }
+}
+#endif
+
+using Kernel = void (*)(uint64_t*);
+
+static Kernel pickKernel(const char** name) {
+#ifdef TRANSPOSE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        *name = "avx2";
+        return transposeAvx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        *name = "sse2";
+        return transposeSse2;
+    }
+#endif
+    *name = "scalar";
+    return transposeScalar;
+}
+
+static const char* kernelName = nullptr;
+static const Kernel kernel = pickKernel(&kernelName);
+
+void transpose64x64(uint64_t* block) { kernel(block); }
+
+const char* transposeKernel() { return kernelName; }
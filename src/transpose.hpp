@@ -0,0 +1,29 @@
+#ifndef TRANSPOSE_H
+#define TRANSPOSE_H
+
+#include <cstdint>
+
+// Bit matrix transposes, turning packed columns (a word holding 64 rows of
+// one column) into packed rows (a word holding up to 64 columns of one row)
+// and back. Bit j of word i always stands for row i, column j.
+
+// Transposes the 8x8 bit matrix in `x`, byte i being row i.
+inline uint64_t transpose8x8(uint64_t x) {
+    uint64_t t;
+    t = (x ^ (x >> 7)) & 0x00aa00aa00aa00aaull;
+    x ^= t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000cccc0000ccccull;
+    x ^= t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000f0f0f0f0ull;
+    x ^= t ^ (t << 28);
+    return x;
+}
+
+// Transposes a 64x64 bit matrix in place. Uses AVX2 or SSE2 when the CPU
+// has them.
+void transpose64x64(uint64_t* block);
+
+// The kernel transpose64x64() runs: "avx2", "sse2" or "scalar".
+const char* transposeKernel();
+
+#endif // TRANSPOSE_H
@@ -0,0 +1,68 @@
+#include "truthtable.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+// Columns of the variables that change within a word: the one whose value
+// flips every row, every 2 rows, ... every 32 rows. Bit b is set when the
+// variable is true in row b.
+static const uint64_t LOW_COLUMNS[6] = {
+    0x5555555555555555ull, 0x3333333333333333ull, 0x0f0f0f0f0f0f0f0full,
+    0x00ff00ff00ff00ffull, 0x0000ffff0000ffffull, 0x00000000ffffffffull,
+};
+
+TruthTable::TruthTable(Interpreter& interpreter,
+                       const std::vector<std::string>& order)
+    : variables(order.empty() ? interpreter.getVariableNames() : order),
+      expression(interpreter.getInfix()), sim(aig, batchWords()) {
+    for (auto& name : interpreter.getVariableNames()) {
+        if (std::find(variables.begin(), variables.end(), name) ==
+            variables.end()) {
+            throw std::runtime_error("variable `" + name +
+                                     "` is not in the table");
+        }
+    }
+    if (variables.size() > MAX_VARIABLES) {
+        throw std::runtime_error("too many variables for a truth table (" +
+                                 std::to_string(variables.size()) +
+                                 ", at most " +
+                                 std::to_string(MAX_VARIABLES) + ")");
+    }
+    // inputs are created up front so that input i is variable i
+    for (auto& name : variables) {
+        aig.namedInput(name);
+    }
+    root = interpreter.buildAIG(aig);
+}
+
+uint64_t TruthTable::variableWord(size_t var, size_t varCount, uint64_t w) {
+    size_t shift = varCount - 1 - var;
+    if (shift < 6) {
+        return LOW_COLUMNS[shift];
+    }
+    return ((w << 6) >> shift) & 1 ? 0 : ~0ull;
+}
+
+void TruthTable::evaluate(Simulator& sim, uint64_t first, size_t count,
+                          uint64_t* out) const {
+    const size_t words = sim.getWords();
+    const uint64_t total = wordCount();
+    while (count > 0) {
+        size_t batch = std::min(count, words);
+        for (size_t i = 0; i < variables.size(); i++) {
+            auto in = sim.inputWords(i);
+            for (size_t w = 0; w < batch; w++) {
+                in[w] = variableWord(i, variables.size(), first + w);
+            }
+        }
+        sim.run();
+        for (size_t w = 0; w < batch; w++) {
+            out[w] = first + w < total ? sim.literalWord(root, w) : 0;
+        }
+        if (first < total && total <= first + batch && rowCount() < 64) {
+            out[total - 1 - first] &= (1ull << rowCount()) - 1;
+        }
+        first += batch;
+        out += batch;
+        count -= batch;
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef TRUTHTABLE_H
+#define TRUTHTABLE_H
+
+#include "aig.hpp"
+#include "interpreter.hpp"
+#include "simulator.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Bit-packed truth table of one expression, evaluated 64 rows per word by
+// simulating its AIG. Rows follow the order of the tabulated tables: in row
+// r, variable i (in order of first appearance) is true unless bit n - 1 - i
+// of r is set, so row 0 is all true. Bit b of result word w holds row
+// 64 * w + b, and the variable columns are never stored since they follow
+// from the row index.
+class TruthTable {
+private:
+    std::vector<std::string> variables;
+    std::string expression;
+    AIG aig;
+    AigLit root;
+    Simulator sim;
+
+    // words simulated per pass, fewer than BATCH_ROWS / 64 for small tables
+    // so that the simulator of a huge expression over few variables stays
+    // small
+    size_t batchWords() const {
+        return variables.size() >= 12 ? BATCH_ROWS / 64 : wordCount();
+    }
+
+public:
+    // rows simulated per pass, a multiple of 64
+    static const size_t BATCH_ROWS = 4096;
+    // keeps the row count and the row indices within 64 bits
+    static const size_t MAX_VARIABLES = 48;
+
+    // Tabulates over the expression's own variables, or over `order` when
+    // given, which must then contain all of them. Throws std::runtime_error
+    // when it does not or when there are too many variables.
+    TruthTable(Interpreter& interpreter,
+               const std::vector<std::string>& order = {});
+    TruthTable(const TruthTable&) = delete;
+    TruthTable& operator=(const TruthTable&) = delete;
+
+    const std::vector<std::string>& getVariables() const { return variables; }
+    const std::string& getExpression() const { return expression; }
+    size_t variableCount() const { return variables.size(); }
+    uint64_t rowCount() const { return 1ull << variables.size(); }
+    uint64_t wordCount() const { return (rowCount() + 63) / 64; }
+
+    // Computes result words [first, first + count). Bits past the last row
+    // are zero.
+    void evaluate(uint64_t first, size_t count, uint64_t* out) {
+        evaluate(sim, first, count, out);
+    }
+    // The same with a simulator from newSimulator(), so that several
+    // threads can evaluate the table at once, each with its own.
+    void evaluate(Simulator& sim, uint64_t first, size_t count,
+                  uint64_t* out) const;
+    Simulator newSimulator() const { return Simulator(aig, batchWords()); }
+
+    // Word w of the column of variable `var` in a table of `varCount`
+    // variables.
+    static uint64_t variableWord(size_t var, size_t varCount, uint64_t w);
+    // Word w of every variable column, in order.
+    static void variableWords(size_t varCount, uint64_t w, uint64_t* out) {
+        for (size_t i = 0; i < varCount; i++) {
+            out[i] = variableWord(i, varCount, w);
+        }
+    }
+    static bool variableValue(size_t var, size_t varCount, uint64_t row) {
+        return !((row >> (varCount - 1 - var)) & 1);
+    }
+};
+
+#endif // TRUTHTABLE_H
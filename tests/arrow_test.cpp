@@ -0,0 +1,120 @@
+// Writes truth tables with writeArrow, maps them back with ArrowFile and
+// checks every column and row against the TruthTable, for tables whose row
+// count is not a multiple of 64 and for one spread over two record batches.
+
+#include "arrow.hpp"
+#include "interpreter.hpp"
+#include "lexer.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+
+static const char* EXPRESSIONS[] = {
+    "a",
+    "a & !b | c",
+    "(a > b) = (c ^ d) | !e",
+    "a & b & c & d & e & f & g",
+    // 2^21 rows, two batches of ARROW_BATCH_ROWS
+    "(a ^ b ^ c ^ d ^ e ^ f ^ g) & (h | i | j | k | l | m | n) > "
+    "(o = p) & !(q & r & s & t & u)",
+};
+
+static uint64_t rowMask(uint64_t rows, uint64_t w) {
+    uint64_t left = rows - 64 * w;
+    return left >= 64 ? ~0ull : (1ull << left) - 1;
+}
+
+// Returns a description of the first mismatch, or nothing.
+static std::string roundTrip(const std::string& expr, const char* path) {
+    Lexer lexer(expr);
+    auto tokens = lexer.tokenize();
+    if (tokens.size() == 0) {
+        return "does not lex";
+    }
+    Interpreter interpreter(tokens);
+    TruthTable table(interpreter);
+    {
+        FILE* file = std::fopen(path, "wb");
+        if (!file) {
+            return "cannot create the file";
+        }
+        OutputBuffer out(fileno(file));
+        writeArrow(table, out);
+        out.flush();
+        std::fclose(file);
+    }
+
+    ArrowFile arrow(path);
+    const size_t n = table.variableCount();
+    if (arrow.getVariables() != table.getVariables() ||
+        arrow.rowCount() != table.rowCount()) {
+        return "the columns or the row count differ";
+    }
+    if (arrow.batchCount() !=
+        (table.rowCount() + ARROW_BATCH_ROWS - 1) / ARROW_BATCH_ROWS) {
+        return std::to_string(arrow.batchCount()) + " record batches";
+    }
+    for (uint64_t w = 0; w < table.wordCount(); w++) {
+        const uint64_t mask = rowMask(table.rowCount(), w);
+        uint64_t result;
+        table.evaluate(w, 1, &result);
+        for (size_t c = 0; c <= n; c++) {
+            uint64_t want =
+                (c < n ? TruthTable::variableWord(c, n, w) : result) & mask;
+            if (arrow.word(c, w) != want) {
+                return "column " + std::to_string(c) + " differs in word " +
+                       std::to_string(w);
+            }
+        }
+    }
+    // cell by cell as well, over the first rows and the last
+    const uint64_t rows = table.rowCount();
+    for (uint64_t r = 0; r < rows; r++) {
+        if (r == 4096 && rows > 8192) {
+            r = rows - 4096;
+        }
+        uint64_t result;
+        table.evaluate(r / 64, 1, &result);
+        for (size_t c = 0; c <= n; c++) {
+            bool want = c < n ? TruthTable::variableWord(c, n, r / 64) >>
+                                    (r % 64) & 1
+                              : result >> (r % 64) & 1;
+            if (arrow.cell(c, r) != want) {
+                return "cell " + std::to_string(c) + " of row " +
+                       std::to_string(r) + " differs";
+            }
+        }
+    }
+    return "";
+}
+
+int main() {
+    char path[] = "/tmp/pensieve_arrow_XXXXXX";
+    int fd = ::mkstemp(path);
+    if (fd < 0) {
+        std::perror("mkstemp");
+        return 1;
+    }
+    ::close(fd);
+
+    int failures = 0;
+    for (auto expr : EXPRESSIONS) {
+        std::string problem;
+        try {
+            problem = roundTrip(expr, path);
+        } catch (const std::exception& e) {
+            problem = e.what();
+        }
+        if (!problem.empty()) {
+            std::printf("arrow: `%s`: %s\n", expr, problem.c_str());
+            failures++;
+        }
+    }
+    ::unlink(path);
+
+    std::printf("arrow: %zu tables, %d failures\n",
+                sizeof EXPRESSIONS / sizeof *EXPRESSIONS, failures);
+    return failures == 0 ? 0 : 1;
+}
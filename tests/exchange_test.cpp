@@ -0,0 +1,86 @@
+// Hammers a tiny ClauseExchange with several producers and consumers at once
+// so that slots are reused while they are being written and read. Every
+// clause carries its producer and its number in each literal, so a clause
+// put together from two publishes is caught.
+
+#include "exchange.hpp"
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+static const uint32_t PRODUCERS = 4;
+static const uint32_t CONSUMERS = 3;
+static const uint32_t CLAUSES = 2000000;
+
+// literal i of clause `number` of `producer`, as a variable and a sign
+static SatLit clauseLit(uint32_t producer, uint32_t number, size_t i) {
+    return satMakeLit((producer << 24) | ((number & 0xffff) << 4) | i,
+                      number & 1);
+}
+
+static bool consistent(uint32_t consumer, const std::vector<SatLit>& lits) {
+    if (lits.empty() || lits.size() > ClauseExchange::MAX_CLAUSE_SIZE) {
+        return false;
+    }
+    const uint32_t producer = satVar(lits[0]) >> 24;
+    const uint32_t number = (satVar(lits[0]) >> 4) & 0xffff;
+    if (producer == consumer || lits.size() != 1 + number % 8) {
+        return false;
+    }
+    for (size_t i = 0; i < lits.size(); i++) {
+        if (lits[i] != clauseLit(producer, number, i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    ClauseExchange exchange(4);
+    std::atomic<uint32_t> running(PRODUCERS);
+    std::atomic<uint64_t> read(0), torn(0);
+
+    std::vector<std::thread> threads;
+    for (uint32_t p = 0; p < PRODUCERS; p++) {
+        threads.emplace_back([&, p] {
+            std::vector<SatLit> lits;
+            for (uint32_t number = 0; number < CLAUSES; number++) {
+                lits.clear();
+                for (size_t i = 0; i < 1 + number % 8; i++) {
+                    lits.push_back(clauseLit(p, number, i));
+                }
+                exchange.publish(p, lits);
+                if (number % 64 == 0) {
+                    std::this_thread::yield();
+                }
+            }
+            running--;
+        });
+    }
+    // the consumers share ids with the producers, so their own clauses are
+    // skipped too
+    for (uint32_t c = 0; c < CONSUMERS; c++) {
+        threads.emplace_back([&, c] {
+            uint64_t cursor = 0;
+            std::vector<std::vector<SatLit>> clauses;
+            while (running > 0) {
+                clauses.clear();
+                read += exchange.collect(c, cursor, clauses);
+                for (auto& clause : clauses) {
+                    if (!consistent(c, clause)) {
+                        torn++;
+                    }
+                }
+                std::this_thread::yield();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::printf("exchange: %llu clauses read, %llu torn\n",
+                (unsigned long long)read, (unsigned long long)torn);
+    return torn == 0 && read > 0 ? 0 : 1;
+}
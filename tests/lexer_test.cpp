@@ -0,0 +1,103 @@
+// Checks the block pass of the lexer against the scalar one on random
+// inputs of BLOCK_BYTES and more, valid ones and ones with a few bytes
+// broken: both must accept or reject the same inputs and make the same
+// tokens. A rejected input must not add any name to the symbol table.
+
+#include "lexer.hpp"
+#include <cstdio>
+#include <random>
+#include <string>
+
+static const int INPUTS = 20000;
+
+static std::string generate(std::mt19937_64& rng) {
+    static const char* OPERANDS[] = {"a", "bb", "x1", "_z", "a_very_long_name"};
+    static const char* OPERATORS[] = {"&", "|", "^", ">", "="};
+    static const char* SPACES[] = {" ", "", "  ", "\t", "\n"};
+    static const char* PIECES[] = {"a", "bb", "x1", "_z", " ", "&",  "|",
+                                   "^", ">",  "=",  "!",  "(", ")",  "  ",
+                                   "1", "a9", "\t", "#",  "A", "\r"};
+    const size_t length = Lexer::BLOCK_BYTES + rng() % 512;
+    std::string s;
+    if (rng() % 4 == 0) {
+        // mostly invalid
+        while (s.size() < length) {
+            s += PIECES[rng() % 20];
+        }
+        return s;
+    }
+    size_t depth = 0;
+    while (s.size() < length) {
+        while (rng() % 4 == 0) {
+            s += rng() % 2 ? "!(" : "(";
+            s += SPACES[rng() % 5];
+            depth++;
+        }
+        if (rng() % 5 == 0) {
+            s += "!";
+        }
+        s += OPERANDS[rng() % 5];
+        while (depth > 0 && rng() % 3 == 0) {
+            s += SPACES[rng() % 5];
+            s += ")";
+            depth--;
+        }
+        s += SPACES[rng() % 5];
+        s += OPERATORS[rng() % 5];
+        s += SPACES[rng() % 5];
+    }
+    s += "q";
+    s.append(depth, ')');
+    // break a few bytes
+    for (int k = rng() % 4; k > 0; k--) {
+        s[rng() % s.size()] = "a&|()! 1X"[rng() % 9];
+    }
+    return s;
+}
+
+int main() {
+    std::mt19937_64 rng(44);
+    int failures = 0, valid = 0;
+    for (int i = 0; i < INPUTS && failures < 10; i++) {
+        auto input = generate(rng);
+        SymbolTable blockNames, scalarNames;
+        Lexer blockLexer(input, std::pmr::get_default_resource(), blockNames);
+        Lexer scalarLexer(input, std::pmr::get_default_resource(),
+                          scalarNames);
+        TokenList blockTokens(std::pmr::get_default_resource());
+        const bool blockValid = blockLexer.tokenizeBlocks(blockTokens);
+        const auto scalarTokens = scalarLexer.tokenizeScalar();
+        const bool scalarValid = scalarTokens.size() != 0;
+
+        std::string problem;
+        if (blockValid != scalarValid) {
+            problem = blockValid ? "accepted by the block pass only"
+                                 : "rejected by the block pass only";
+        } else if (!blockValid &&
+                   (blockNames.size() != 0 || scalarNames.size() != 0)) {
+            problem = "rejected but names were interned";
+        } else if (blockValid) {
+            valid++;
+            if (blockTokens.size() != scalarTokens.size()) {
+                problem = "different token counts";
+            }
+            for (size_t t = 0; problem.empty() && t < blockTokens.size();
+                 t++) {
+                const Token &a = blockTokens[t], &b = scalarTokens[t];
+                if (a.getTokenType() != b.getTokenType() ||
+                    (a.isVariable() && blockNames.name(a.getSymbol()) !=
+                                           scalarNames.name(b.getSymbol()))) {
+                    problem = "token " + std::to_string(t) + " differs";
+                }
+            }
+        }
+        if (!problem.empty()) {
+            std::printf("lexer: %s: %s\n", problem.c_str(), input.c_str());
+            failures++;
+        }
+    }
+
+    std::printf("lexer: %d inputs, %d valid, %d failures\n", INPUTS, valid,
+                failures);
+    return failures == 0 && valid > 0 && valid < INPUTS ? 0 : 1;
+}
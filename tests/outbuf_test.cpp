@@ -0,0 +1,91 @@
+// Fills OutputBuffers far past their capacity, one byte at a time with put()
+// and in runs with append(), and checks that a MEMORY buffer keeps every
+// byte in order while one on a pipe writes them all out.
+
+#include "outbuf.hpp"
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+
+static const size_t CAPACITY = 64;
+static const size_t BYTES = 10 * CAPACITY + 7;
+
+static char byteAt(size_t i) { return 'a' + i % 26; }
+
+// Writes BYTES bytes, alternating single put()s and short append()s.
+static void fill(OutputBuffer& out) {
+    for (size_t i = 0; i < BYTES;) {
+        if (i % 3 == 0) {
+            out.put(byteAt(i++));
+            continue;
+        }
+        std::string run;
+        for (size_t k = 0; k < 5 && i < BYTES; k++) {
+            run += byteAt(i++);
+        }
+        out.append(run);
+    }
+}
+
+static bool expected(const char* data, size_t size) {
+    if (size != BYTES) {
+        return false;
+    }
+    for (size_t i = 0; i < size; i++) {
+        if (data[i] != byteAt(i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    int failures = 0;
+
+    OutputBuffer memory(OutputBuffer::MEMORY, CAPACITY);
+    for (size_t i = 0; i < BYTES; i++) {
+        memory.put(byteAt(i));
+    }
+    if (!expected(memory.data(), memory.size())) {
+        std::printf("outbuf: MEMORY put() lost or reordered bytes\n");
+        failures++;
+    }
+    memory.clear();
+    fill(memory);
+    if (!expected(memory.data(), memory.size()) ||
+        memory.bytesWritten() != BYTES) {
+        std::printf("outbuf: MEMORY put() and append() lost bytes\n");
+        failures++;
+    }
+
+    int pipes[2];
+    if (::pipe(pipes) != 0) {
+        std::perror("pipe");
+        return 1;
+    }
+    {
+        // the pipe holds far more than BYTES, so nothing blocks
+        OutputBuffer out(pipes[1], CAPACITY);
+        fill(out);
+        out.flush();
+        if (out.bytesWritten() != BYTES) {
+            std::printf("outbuf: %zu of %zu bytes written to the pipe\n",
+                        out.bytesWritten(), BYTES);
+            failures++;
+        }
+    }
+    ::close(pipes[1]);
+    std::string piped;
+    char chunk[256];
+    for (ssize_t n; (n = ::read(pipes[0], chunk, sizeof chunk)) > 0;) {
+        piped.append(chunk, n);
+    }
+    ::close(pipes[0]);
+    if (!expected(piped.data(), piped.size())) {
+        std::printf("outbuf: the pipe received the wrong bytes\n");
+        failures++;
+    }
+
+    std::printf("outbuf: %d failures\n", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,264 @@
+// Checks the Pratt parser against an independent recursive precedence
+// climbing parser: for random expressions the printed infix and every row of
+// the truth table must match. Fixed cases pin down how operators of equal
+// precedence group and which malformed inputs the lexer rejects.
+
+#include "interpreter.hpp"
+#include "lexer.hpp"
+#include "truthtable.hpp"
+#include <cctype>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+static const int RANDOM_EXPRESSIONS = 9000;
+
+// The reference parser, on its own tokenizer and tree.
+struct RefNode {
+    std::string op; // a variable name when there are no operands
+    std::unique_ptr<RefNode> left, right;
+};
+
+class RefParser {
+private:
+    std::vector<std::string> tokens;
+    size_t pos = 0;
+
+    // binding power and right associativity of each binary operator
+    static bool binary(const std::string& op, int& power, bool& right) {
+        static const std::map<std::string, std::pair<int, bool>> OPS = {
+            {"=", {1, false}}, {">", {2, true}}, {"|", {3, false}},
+            {"^", {4, false}}, {"&", {5, false}}};
+        auto it = OPS.find(op);
+        if (it == OPS.end()) {
+            return false;
+        }
+        power = it->second.first;
+        right = it->second.second;
+        return true;
+    }
+
+    std::unique_ptr<RefNode> primary() {
+        auto node = std::make_unique<RefNode>();
+        auto token = tokens.at(pos++);
+        if (token == "!") {
+            node->op = "!";
+            node->left = primary();
+        } else if (token == "(") {
+            node = expression(0);
+            pos++; // the closing parenthesis
+        } else {
+            node->op = token;
+        }
+        return node;
+    }
+
+    std::unique_ptr<RefNode> expression(int minPower) {
+        auto lhs = primary();
+        int power;
+        bool right;
+        while (pos < tokens.size() && binary(tokens[pos], power, right) &&
+               power >= minPower) {
+            auto node = std::make_unique<RefNode>();
+            node->op = tokens[pos++];
+            node->left = std::move(lhs);
+            node->right = expression(right ? power : power + 1);
+            lhs = std::move(node);
+        }
+        return lhs;
+    }
+
+public:
+    RefParser(const std::string& expr) {
+        for (size_t i = 0; i < expr.size();) {
+            if (std::isspace((unsigned char)expr[i])) {
+                i++;
+            } else if (std::isalpha((unsigned char)expr[i]) || expr[i] == '_') {
+                size_t j = i;
+                while (j < expr.size() &&
+                       (std::isalnum((unsigned char)expr[j]) || expr[j] == '_')) {
+                    j++;
+                }
+                tokens.push_back(expr.substr(i, j - i));
+                i = j;
+            } else {
+                tokens.push_back(std::string(1, expr[i++]));
+            }
+        }
+    }
+    std::unique_ptr<RefNode> parse() { return expression(0); }
+};
+
+static std::string show(const RefNode& node) {
+    if (node.op == "!") {
+        return "!(" + show(*node.left) + ")";
+    }
+    if (!node.left) {
+        return node.op;
+    }
+    return "(" + show(*node.left) + " " + node.op + " " + show(*node.right) +
+           ")";
+}
+
+static bool eval(const RefNode& node, const std::map<std::string, bool>& env) {
+    if (node.op == "!") {
+        return !eval(*node.left, env);
+    }
+    if (!node.left) {
+        return env.at(node.op);
+    }
+    bool a = eval(*node.left, env), b = eval(*node.right, env);
+    switch (node.op[0]) {
+    case '&':
+        return a && b;
+    case '|':
+        return a || b;
+    case '^':
+        return a != b;
+    case '>':
+        return !a || b;
+    default:
+        return a == b;
+    }
+}
+
+static std::string generate(std::mt19937& rng, int depth) {
+    static const char* VARIABLES[] = {"a", "b", "c", "dd", "x_1"};
+    static const char* OPERATORS[] = {" = ", " > ", " | ", " ^ ", " & "};
+    std::string expr;
+    const int operands = 1 + rng() % 4;
+    for (int i = 0; i < operands; i++) {
+        if (i > 0) {
+            expr += OPERATORS[rng() % 5];
+        }
+        const unsigned bangs = rng() % 5;
+        expr.append(bangs >= 3 ? bangs - 2 : 0, '!');
+        if (depth < 4 && rng() % 10 < 3) {
+            expr += "(" + generate(rng, depth + 1) + ")";
+        } else {
+            expr += VARIABLES[rng() % 5];
+        }
+    }
+    return expr;
+}
+
+// Returns a description of the first difference from the reference, or
+// nothing.
+static std::string compare(const std::string& expr) {
+    Lexer lexer(expr);
+    auto tokens = lexer.tokenize();
+    if (tokens.size() == 0) {
+        return "rejected";
+    }
+    Interpreter interpreter(tokens);
+    auto reference = RefParser(expr).parse();
+    const std::string infix = interpreter.getInfix();
+    if (infix != show(*reference)) {
+        return "printed as " + infix + ", expected " + show(*reference);
+    }
+
+    const auto names = interpreter.getVariableNames();
+    const size_t n = names.size();
+    const uint64_t rows = 1ull << n;
+    for (uint64_t w = 0; w < (rows + 63) / 64; w++) {
+        const uint64_t word = interpreter.evaluateWord(w);
+        for (uint64_t row = 64 * w; row < std::min(rows, 64 * w + 64);
+             row++) {
+            std::map<std::string, bool> env;
+            for (size_t v = 0; v < n; v++) {
+                env[names[v]] =
+                    (TruthTable::variableWord(v, n, w) >> (row % 64)) & 1;
+            }
+            if (((word >> (row % 64)) & 1) != eval(*reference, env)) {
+                return "row " + std::to_string(row) + " differs";
+            }
+        }
+    }
+    return "";
+}
+
+// Operators of equal precedence: implication groups to the right, even
+// around a tighter operator, the others to the left.
+static const std::pair<const char*, const char*> GROUPING[] = {
+    {"a > b > c", "(a > (b > c))"},
+    {"a > b & c > d", "(a > ((b & c) > d))"},
+    {"a & b > c & d > e", "((a & b) > ((c & d) > e))"},
+    {"a = b = c", "((a = b) = c)"},
+    {"a | b | c", "((a | b) | c)"},
+    {"a ^ b ^ c", "((a ^ b) ^ c)"},
+    {"a & b & c", "((a & b) & c)"},
+    {"a = b > c | d ^ e & !f", "(a = (b > (c | (d ^ (e & !(f))))))"},
+};
+
+// Parentheses that do not surround an operand, accepted before the Pratt
+// parser.
+static const char* REJECTED[] = {
+    "a (& b)", "(a &) b", "a (b)", "(a) b", "a !b",  "()",
+    "a & ()",  "(a & b", "a & b)", "a & & b", "a &", "& a",
+};
+
+// An expression lexed into a table of its own, as the ingest workers do,
+// must print and evaluate with its own names even when the session's table
+// gives the same ids to others.
+static bool ownTable() {
+    Lexer session("zz & yy");
+    session.tokenize();
+    SymbolTable names;
+    Lexer lexer("a & !b > a", std::pmr::get_default_resource(), names);
+    auto tokens = lexer.tokenize();
+    if (tokens.size() == 0) {
+        return false;
+    }
+    Interpreter interpreter(tokens, std::pmr::get_default_resource(), names);
+    return interpreter.getInfix() == "((a & !(b)) > a)" &&
+           interpreter.getVariableNames() ==
+               std::vector<std::string>{"a", "b"} &&
+           tokens[0].getValue(names) == "a" &&
+           interpreter.evaluateWord(0) == 0xf;
+}
+
+int main() {
+    int failures = 0;
+    if (!ownTable()) {
+        std::printf("parser: an expression lexed into its own symbol table "
+                    "printed the session's names\n");
+        failures++;
+    }
+    for (auto& [expr, infix] : GROUPING) {
+        Lexer lexer(expr);
+        auto tokens = lexer.tokenize();
+        std::string got =
+            tokens.size() == 0 ? "rejected" : Interpreter(tokens).getInfix();
+        if (got != infix) {
+            std::printf("parser: `%s` printed as %s, expected %s\n", expr,
+                        got.c_str(), infix);
+            failures++;
+        }
+    }
+    for (auto expr : REJECTED) {
+        Lexer lexer(expr);
+        if (lexer.tokenize().size() != 0 || lexer.getDiagnostics().empty()) {
+            std::printf("parser: `%s` was accepted\n", expr);
+            failures++;
+        }
+    }
+
+    std::mt19937 rng(45);
+    for (int i = 0; i < RANDOM_EXPRESSIONS; i++) {
+        auto expr = generate(rng, 0);
+        auto problem = compare(expr);
+        if (!problem.empty()) {
+            std::printf("parser: `%s`: %s\n", expr.c_str(), problem.c_str());
+            failures++;
+        }
+    }
+
+    std::printf("parser: %zu fixed and %d random expressions, %d failures\n",
+                1 + sizeof GROUPING / sizeof *GROUPING +
+                    sizeof REJECTED / sizeof *REJECTED,
+                RANDOM_EXPRESSIONS, failures);
+    return failures == 0 ? 0 : 1;
+}